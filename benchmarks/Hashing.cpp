@@ -0,0 +1,169 @@
+// Compares Core::FastHash64 with the byte-wise FNV-1a previously used for flat value pooling.
+// The inputs mimic the values of the flat buffer: the sizes of the common flat types
+// and the way the pool feeds them to the hash function, including per element hashing of string arrays.
+
+#include "Core/Hashing/FastHash.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr uint64_t FNVBasis = 0xCBF29CE484222325ull;
+constexpr uint64_t FNVPrime = 0x100000001B3ull;
+
+// Same as Red::FNV1a64
+uint64_t FNV1a64(const uint8_t* aData, size_t aSize, uint64_t aSeed = FNVBasis)
+{
+    for (size_t i = 0; i < aSize; ++i)
+    {
+        aSeed ^= aData[i];
+        aSeed *= FNVPrime;
+    }
+    return aSeed;
+}
+
+struct Value
+{
+    std::vector<uint8_t> bytes;
+    std::vector<uint32_t> parts; // lengths of string array elements, empty for plain values
+};
+
+struct Distribution
+{
+    const char* name;
+    size_t count;
+    size_t minSize;
+    size_t maxSize;
+    bool isStringArray;
+};
+
+// Roughly follows the share of each flat type in the game's buffer
+constexpr Distribution Distributions[] = {
+    {"Bool", 40000, 1, 1, false},
+    {"Int32", 120000, 4, 4, false},
+    {"Float", 180000, 4, 4, false},
+    {"TweakDBID", 160000, 8, 8, false},
+    {"CName", 60000, 8, 8, false},
+    {"Vector3", 8000, 12, 12, false},
+    {"Quaternion", 2000, 16, 16, false},
+    {"String", 30000, 4, 48, false},
+    {"array:TweakDBID", 60000, 0, 16 * 8, false},
+    {"array:TweakDBID (long)", 2000, 32 * 8, 512 * 8, false},
+    {"array:String", 4000, 0, 8, true},
+};
+
+Value MakeValue(const Distribution& aDist, std::mt19937_64& aRandom)
+{
+    Value value;
+    const auto size = std::uniform_int_distribution<size_t>(aDist.minSize, aDist.maxSize)(aRandom);
+
+    if (aDist.isStringArray)
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            const auto length = static_cast<uint32_t>(aRandom() % 24);
+            value.parts.push_back(length);
+            for (uint32_t j = 0; j < length; ++j)
+            {
+                value.bytes.push_back(static_cast<uint8_t>('a' + aRandom() % 26));
+            }
+        }
+    }
+    else
+    {
+        value.bytes.resize(size);
+        for (auto& byte : value.bytes)
+        {
+            byte = static_cast<uint8_t>(aRandom());
+        }
+    }
+
+    return value;
+}
+
+template<typename Hasher>
+uint64_t HashValue(const Value& aValue, uint64_t aSeed, Hasher&& aHasher)
+{
+    if (aValue.parts.empty())
+        return aHasher(aValue.bytes.data(), aValue.bytes.size(), aSeed);
+
+    auto hash = aSeed;
+    const auto* data = aValue.bytes.data();
+
+    for (const auto length : aValue.parts)
+    {
+        hash = aHasher(reinterpret_cast<const uint8_t*>(&length), sizeof(length), hash);
+        hash = aHasher(data, length, hash);
+        data += length;
+    }
+
+    return hash;
+}
+
+template<typename Hasher>
+double Measure(const std::vector<Value>& aValues, uint64_t aSeed, Hasher&& aHasher, uint64_t& aChecksum)
+{
+    constexpr auto Rounds = 5;
+    auto best = std::chrono::nanoseconds::max();
+
+    for (auto round = 0; round < Rounds; ++round)
+    {
+        uint64_t checksum = 0;
+        const auto start = std::chrono::steady_clock::now();
+
+        for (const auto& value : aValues)
+        {
+            checksum ^= HashValue(value, aSeed, aHasher);
+        }
+
+        best = std::min(best, std::chrono::steady_clock::now() - start);
+        aChecksum = checksum;
+    }
+
+    return std::chrono::duration<double, std::nano>(best).count() / static_cast<double>(aValues.size());
+}
+}
+
+int main()
+{
+    std::mt19937_64 random(42);
+
+    const auto fnvHasher = [](const uint8_t* aData, size_t aSize, uint64_t aSeed) {
+        return FNV1a64(aData, aSize, aSeed);
+    };
+    const auto fastHasher = [](const uint8_t* aData, size_t aSize, uint64_t aSeed) {
+        return Core::FastHash64(aData, aSize, aSeed);
+    };
+
+    std::printf("%-24s %8s %10s %10s %10s %8s\n", "type", "values", "avg bytes", "fnv ns", "fast ns", "speedup");
+
+    for (const auto& dist : Distributions)
+    {
+        std::vector<Value> values;
+        values.reserve(dist.count);
+
+        size_t bytes = 0;
+        for (size_t i = 0; i < dist.count; ++i)
+        {
+            values.push_back(MakeValue(dist, random));
+            bytes += values.back().bytes.size();
+        }
+
+        uint64_t fnvChecksum = 0;
+        uint64_t fastChecksum = 0;
+        const auto fnvTime = Measure(values, FNVBasis, fnvHasher, fnvChecksum);
+        const auto fastTime = Measure(values, FNVBasis, fastHasher, fastChecksum);
+
+        // The checksums keep the hashing from being optimized away
+        std::printf("%-24s %8zu %10.1f %10.2f %10.2f %7.2fx  %016llx %016llx\n", dist.name, dist.count,
+                    static_cast<double>(bytes) / static_cast<double>(dist.count), fnvTime, fastTime,
+                    fnvTime / fastTime, static_cast<unsigned long long>(fnvChecksum),
+                    static_cast<unsigned long long>(fastChecksum));
+    }
+
+    return 0;
+}
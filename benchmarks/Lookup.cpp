@@ -0,0 +1,333 @@
+// Measures how fast flat values are resolved from buffer offsets, which is the path every GetFlat takes.
+// The buffer is filled with polymorphic values laid out like the game's flats: [ VFT ][ padding ][ data ].
+// Every offset is resolved through the virtual GetValue() that the game uses, through the VFT hash map
+// used before, through the fixed VFT table, and through the typed path that validates the expected type.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "Core/Stl.hpp"
+#include "Red/TweakDB/FlatTypeTable.hpp"
+
+namespace
+{
+struct TypeDesc
+{
+    size_t index;
+};
+
+struct Resolved
+{
+    const TypeDesc* type;
+    void* data;
+};
+
+struct FlatValue
+{
+    virtual Resolved GetValue() = 0;
+};
+
+template<size_t N>
+inline constexpr TypeDesc TypeDescs{N};
+
+// The game has a few dozen flat types, most of them are 4 to 16 bytes, Quaternion is 16-byte aligned
+template<typename V, size_t N>
+struct TypedFlatValue : FlatValue
+{
+    Resolved GetValue() override
+    {
+        return {&TypeDescs<N>, &value};
+    }
+
+    V value{};
+};
+
+struct Vector3
+{
+    float x, y, z;
+};
+
+struct alignas(16) Quaternion
+{
+    float i, j, k, r;
+};
+
+struct Array
+{
+    void* entries;
+    uint32_t capacity;
+    uint32_t size;
+};
+
+struct TypeInfo
+{
+    const TypeDesc* type;
+    uintptr_t offset;
+};
+
+constexpr size_t ValueCount = 1 << 20;
+constexpr size_t Rounds = 5;
+
+class Buffer
+{
+public:
+    template<typename T>
+    void Add(uint32_t aWeight)
+    {
+        m_factories.push_back({aWeight, sizeof(T), alignof(T), [](void* aAddr) { new (aAddr) T(); }});
+    }
+
+    void Fill(size_t aCount, std::mt19937_64& aRandom)
+    {
+        uint32_t totalWeight = 0;
+        for (const auto& factory : m_factories)
+        {
+            totalWeight += factory.weight;
+        }
+
+        std::vector<const Factory*> picks;
+        size_t size = 0;
+
+        for (size_t i = 0; i < aCount; ++i)
+        {
+            auto roll = static_cast<uint32_t>(aRandom() % totalWeight);
+            for (const auto& factory : m_factories)
+            {
+                if (roll < factory.weight)
+                {
+                    picks.push_back(&factory);
+                    size = AlignUp(size, factory.alignment) + factory.size;
+                    break;
+                }
+                roll -= factory.weight;
+            }
+        }
+
+        m_data.reset(static_cast<uint8_t*>(::operator new(size, std::align_val_t{16})));
+        m_offsets.clear();
+
+        size_t offset = 0;
+        for (const auto* factory : picks)
+        {
+            offset = AlignUp(offset, factory->alignment);
+            factory->construct(m_data.get() + offset);
+            m_offsets.push_back(static_cast<int32_t>(offset));
+            offset += factory->size;
+        }
+    }
+
+    [[nodiscard]] uint8_t* GetData() const
+    {
+        return m_data.get();
+    }
+
+    [[nodiscard]] const std::vector<int32_t>& GetOffsets() const
+    {
+        return m_offsets;
+    }
+
+private:
+    struct Factory
+    {
+        uint32_t weight;
+        size_t size;
+        size_t alignment;
+        void (*construct)(void*);
+    };
+
+    struct Deleter
+    {
+        void operator()(uint8_t* aData) const
+        {
+            ::operator delete(aData, std::align_val_t{16});
+        }
+    };
+
+    static size_t AlignUp(size_t aValue, size_t aAlignment)
+    {
+        return (aValue + aAlignment - 1) & ~(aAlignment - 1);
+    }
+
+    std::vector<Factory> m_factories;
+    std::unique_ptr<uint8_t, Deleter> m_data;
+    std::vector<int32_t> m_offsets;
+};
+
+void FillTypes(Buffer& aBuffer)
+{
+    aBuffer.Add<TypedFlatValue<float, 0>>(180);
+    aBuffer.Add<TypedFlatValue<int32_t, 1>>(120);
+    aBuffer.Add<TypedFlatValue<uint64_t, 2>>(160); // TweakDBID
+    aBuffer.Add<TypedFlatValue<uint64_t, 3>>(60); // CName
+    aBuffer.Add<TypedFlatValue<bool, 4>>(40);
+    aBuffer.Add<TypedFlatValue<Array, 5>>(60); // array:TweakDBID
+    aBuffer.Add<TypedFlatValue<Array, 6>>(10); // String
+    aBuffer.Add<TypedFlatValue<Vector3, 7>>(8);
+    aBuffer.Add<TypedFlatValue<Quaternion, 8>>(2);
+    aBuffer.Add<TypedFlatValue<Vector3, 9>>(2); // EulerAngles
+    aBuffer.Add<TypedFlatValue<uint64_t, 10>>(4); // gamedataLocKeyWrapper
+    aBuffer.Add<TypedFlatValue<uint64_t, 11>>(4); // raRef:CResource
+
+    // Rare types, including the arrays of all of the above
+    aBuffer.Add<TypedFlatValue<Array, 12>>(6);
+    aBuffer.Add<TypedFlatValue<Array, 13>>(6);
+    aBuffer.Add<TypedFlatValue<Array, 14>>(4);
+    aBuffer.Add<TypedFlatValue<Array, 15>>(4);
+    aBuffer.Add<TypedFlatValue<Array, 16>>(2);
+    aBuffer.Add<TypedFlatValue<Array, 17>>(2);
+    aBuffer.Add<TypedFlatValue<Array, 18>>(1);
+    aBuffer.Add<TypedFlatValue<Array, 19>>(1);
+    aBuffer.Add<TypedFlatValue<Array, 20>>(1);
+    aBuffer.Add<TypedFlatValue<Array, 21>>(1);
+    aBuffer.Add<TypedFlatValue<Array, 22>>(1);
+    aBuffer.Add<TypedFlatValue<Array, 23>>(1);
+}
+
+uintptr_t GetVFT(const uint8_t* aAddr)
+{
+    return *reinterpret_cast<const uintptr_t*>(aAddr);
+}
+
+Resolved ResolveVirtual(uint8_t* aAddr)
+{
+    return reinterpret_cast<FlatValue*>(aAddr)->GetValue();
+}
+
+template<typename Callback>
+double Measure(const std::vector<int32_t>& aOffsets, Callback&& aResolve, uintptr_t& aChecksum)
+{
+    auto best = std::chrono::nanoseconds::max();
+
+    for (size_t round = 0; round < Rounds; ++round)
+    {
+        uintptr_t checksum = 0;
+        const auto start = std::chrono::steady_clock::now();
+
+        for (const auto offset : aOffsets)
+        {
+            const auto resolved = aResolve(offset);
+            checksum += reinterpret_cast<uintptr_t>(resolved.data) ^ resolved.type->index;
+        }
+
+        best = std::min(best, std::chrono::steady_clock::now() - start);
+        aChecksum = checksum;
+    }
+
+    return std::chrono::duration<double, std::nano>(best).count() / static_cast<double>(aOffsets.size());
+}
+}
+
+int main()
+{
+    std::mt19937_64 random(42);
+
+    Buffer buffer;
+    FillTypes(buffer);
+    buffer.Fill(ValueCount, random);
+
+    auto* data = buffer.GetData();
+
+    // Both lookups are filled the same way the buffer does it, on the first miss
+    Core::Map<uintptr_t, TypeInfo> typeMap;
+    Red::TweakDBFlatTypeTable<TypeInfo> typeTable;
+    std::vector<const TypeDesc*> expectedTypes(ValueCount);
+
+    for (size_t i = 0; i < ValueCount; ++i)
+    {
+        auto* addr = data + buffer.GetOffsets()[i];
+        const auto resolved = ResolveVirtual(addr);
+        const TypeInfo info{resolved.type, static_cast<uintptr_t>(static_cast<uint8_t*>(resolved.data) - addr)};
+
+        typeMap.emplace(GetVFT(addr), info);
+        typeTable.Insert(GetVFT(addr), info);
+        expectedTypes[i] = resolved.type;
+    }
+
+    // Offsets in buffer order and in random order, which is closer to looking up flats by ID
+    auto sequential = buffer.GetOffsets();
+    auto shuffled = sequential;
+    std::shuffle(shuffled.begin(), shuffled.end(), random);
+
+    // The typed path needs the expected type of every offset
+    Core::Map<int32_t, const TypeDesc*> expectedByOffset;
+    for (size_t i = 0; i < ValueCount; ++i)
+    {
+        expectedByOffset.emplace(sequential[i], expectedTypes[i]);
+    }
+
+    const auto resolveVirtual = [data](int32_t aOffset) {
+        return ResolveVirtual(data + aOffset);
+    };
+
+    const auto resolveMap = [data, &typeMap](int32_t aOffset) {
+        auto* addr = data + aOffset;
+        const auto it = typeMap.find(GetVFT(addr));
+        if (it != typeMap.end())
+            return Resolved{it->second.type, addr + it->second.offset};
+        return ResolveVirtual(addr);
+    };
+
+    const auto resolveTable = [data, &typeTable](int32_t aOffset) {
+        auto* addr = data + aOffset;
+        const auto* info = typeTable.Find(GetVFT(addr));
+        if (info)
+            return Resolved{info->type, addr + info->offset};
+        return ResolveVirtual(addr);
+    };
+
+    std::printf("%u flat types, %zu values\n", static_cast<uint32_t>(typeTable.GetSize()), ValueCount);
+    std::printf("%-12s %10s %10s %10s %10s\n", "order", "virtual ns", "map ns", "table ns", "typed ns");
+
+    for (const auto* order : {&sequential, &shuffled})
+    {
+        // The expected types are looked up before timing, callers of the typed path already know them
+        std::vector<std::pair<int32_t, const TypeDesc*>> typedLookups;
+        typedLookups.reserve(order->size());
+        for (const auto offset : *order)
+        {
+            typedLookups.emplace_back(offset, expectedByOffset[offset]);
+        }
+
+        std::vector<int32_t> indices(order->size());
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            indices[i] = static_cast<int32_t>(i);
+        }
+
+        const auto resolveTyped = [data, &typeTable, &typedLookups](int32_t aIndex) {
+            const auto& [offset, expectedType] = typedLookups[aIndex];
+            auto* addr = data + offset;
+            const auto* info = typeTable.Find(GetVFT(addr));
+            if (!info || info->type != expectedType)
+                return ResolveVirtual(addr);
+            return Resolved{info->type, addr + info->offset};
+        };
+
+        uintptr_t virtualChecksum = 0;
+        uintptr_t mapChecksum = 0;
+        uintptr_t tableChecksum = 0;
+        uintptr_t typedChecksum = 0;
+
+        const auto virtualTime = Measure(*order, resolveVirtual, virtualChecksum);
+        const auto mapTime = Measure(*order, resolveMap, mapChecksum);
+        const auto tableTime = Measure(*order, resolveTable, tableChecksum);
+        const auto typedTime = Measure(indices, resolveTyped, typedChecksum);
+
+        std::printf("%-12s %10.2f %10.2f %10.2f %10.2f\n", order == &sequential ? "sequential" : "random",
+                    virtualTime, mapTime, tableTime, typedTime);
+
+        // All paths must resolve the same values
+        if (virtualChecksum != mapChecksum || virtualChecksum != tableChecksum || virtualChecksum != typedChecksum)
+        {
+            std::printf("Resolved values don't match\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Core
+{
+namespace Detail
+{
+constexpr uint64_t HashPrime0 = 0xA0761D6478BD642Full;
+constexpr uint64_t HashPrime1 = 0xE7037ED1A0B428DBull;
+constexpr uint64_t HashPrime2 = 0x8EBC6AF09C88C6E3ull;
+constexpr uint64_t HashPrime3 = 0x589965CC75374CC3ull;
+
+// Inputs of this size and larger are consumed in 64 byte stripes using SIMD
+constexpr size_t HashStripeSize = 64;
+constexpr size_t HashStripeThreshold = 256;
+
+alignas(32) constexpr uint64_t HashStripeKeys[8] = {
+    0xBE4BA423396CFEB8ull, 0x1CAD21F72C81017Cull, 0xDB979083E96DD4DEull, 0x1F67B3B7A4A44072ull,
+    0x78E5C0CC4EE679CBull, 0x2172FFCC7DD05A82ull, 0x8E2443F7744608B8ull, 0x4C263A81E69035E0ull,
+};
+
+inline uint64_t HashRead64(const uint8_t* aData)
+{
+    uint64_t value;
+    std::memcpy(&value, aData, sizeof(value));
+    return value;
+}
+
+inline uint64_t HashRead32(const uint8_t* aData)
+{
+    uint32_t value;
+    std::memcpy(&value, aData, sizeof(value));
+    return value;
+}
+
+inline uint64_t HashRead3(const uint8_t* aData, size_t aSize)
+{
+    return (static_cast<uint64_t>(aData[0]) << 16) | (static_cast<uint64_t>(aData[aSize >> 1]) << 8)
+           | aData[aSize - 1];
+}
+
+inline void HashMultiply(uint64_t& aLow, uint64_t& aHigh)
+{
+#ifdef _MSC_VER
+    aLow = _umul128(aLow, aHigh, &aHigh);
+#else
+    const auto product = static_cast<unsigned __int128>(aLow) * aHigh;
+    aLow = static_cast<uint64_t>(product);
+    aHigh = static_cast<uint64_t>(product >> 64);
+#endif
+}
+
+inline uint64_t HashMix(uint64_t aLhs, uint64_t aRhs)
+{
+    HashMultiply(aLhs, aRhs);
+    return aLhs ^ aRhs;
+}
+
+// Accumulates the stripes into 8 independent 64-bit lanes.
+// Both paths produce the same result, AVX2 is used when the build targets it.
+inline void HashStripes(uint64_t* aAcc, const uint8_t* aData, size_t aCount)
+{
+#ifdef __AVX2__
+    auto acc0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(aAcc));
+    auto acc1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(aAcc + 4));
+    const auto key0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(HashStripeKeys));
+    const auto key1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(HashStripeKeys + 4));
+
+    for (size_t i = 0; i < aCount; ++i, aData += HashStripeSize)
+    {
+        const auto data0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aData));
+        const auto data1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aData + 32));
+        const auto mixed0 = _mm256_xor_si256(data0, key0);
+        const auto mixed1 = _mm256_xor_si256(data1, key1);
+
+        acc0 = _mm256_add_epi64(acc0, _mm256_mul_epu32(mixed0, _mm256_srli_epi64(mixed0, 32)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_mul_epu32(mixed1, _mm256_srli_epi64(mixed1, 32)));
+        acc0 = _mm256_add_epi64(acc0, _mm256_shuffle_epi32(data0, _MM_SHUFFLE(1, 0, 3, 2)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_shuffle_epi32(data1, _MM_SHUFFLE(1, 0, 3, 2)));
+    }
+
+    _mm256_store_si256(reinterpret_cast<__m256i*>(aAcc), acc0);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(aAcc + 4), acc1);
+#else
+    __m128i acc[4];
+    __m128i key[4];
+
+    for (size_t lane = 0; lane < 4; ++lane)
+    {
+        acc[lane] = _mm_load_si128(reinterpret_cast<const __m128i*>(aAcc + lane * 2));
+        key[lane] = _mm_load_si128(reinterpret_cast<const __m128i*>(HashStripeKeys + lane * 2));
+    }
+
+    for (size_t i = 0; i < aCount; ++i, aData += HashStripeSize)
+    {
+        for (size_t lane = 0; lane < 4; ++lane)
+        {
+            const auto data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aData + lane * 16));
+            const auto mixed = _mm_xor_si128(data, key[lane]);
+
+            acc[lane] = _mm_add_epi64(acc[lane], _mm_mul_epu32(mixed, _mm_srli_epi64(mixed, 32)));
+            acc[lane] = _mm_add_epi64(acc[lane], _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2)));
+        }
+    }
+
+    for (size_t lane = 0; lane < 4; ++lane)
+    {
+        _mm_store_si128(reinterpret_cast<__m128i*>(aAcc + lane * 2), acc[lane]);
+    }
+#endif
+}
+}
+
+// Identifies the results of FastHash64, must be changed whenever the algorithm changes.
+constexpr uint32_t FastHashVersion = 1;
+
+// Non-cryptographic 64-bit hash for in-memory lookups.
+// Short inputs are hashed with a few multiplications, long inputs are consumed in SIMD stripes.
+// The result isn't stable across versions, anything persisted must be stored along with FastHashVersion.
+inline uint64_t FastHash64(const void* aData, size_t aSize, uint64_t aSeed = 0)
+{
+    using namespace Detail;
+
+    const auto* data = static_cast<const uint8_t*>(aData);
+    auto seed = aSeed ^ HashMix(aSeed ^ HashPrime0, HashPrime1);
+    uint64_t a;
+    uint64_t b;
+
+    if (aSize <= 16)
+    {
+        if (aSize >= 4)
+        {
+            const auto shift = (aSize >> 3) << 2;
+            a = (HashRead32(data) << 32) | HashRead32(data + shift);
+            b = (HashRead32(data + aSize - 4) << 32) | HashRead32(data + aSize - 4 - shift);
+        }
+        else if (aSize > 0)
+        {
+            a = HashRead3(data, aSize);
+            b = 0;
+        }
+        else
+        {
+            a = 0;
+            b = 0;
+        }
+    }
+    else
+    {
+        auto remaining = aSize;
+
+        if (remaining >= HashStripeThreshold)
+        {
+            alignas(32) uint64_t acc[8] = {
+                HashPrime0, HashPrime1, HashPrime2, HashPrime3,
+                ~HashPrime0, ~HashPrime1, ~HashPrime2, ~HashPrime3,
+            };
+
+            // At least one byte is left for the final mixing
+            const auto stripes = (remaining - 1) / HashStripeSize;
+
+            HashStripes(acc, data, stripes);
+
+            data += stripes * HashStripeSize;
+            remaining -= stripes * HashStripeSize;
+
+            for (size_t lane = 0; lane < 8; lane += 2)
+            {
+                seed = HashMix(acc[lane] ^ HashPrime1, acc[lane + 1] ^ seed);
+            }
+        }
+
+        if (remaining > 48)
+        {
+            auto seed1 = seed;
+            auto seed2 = seed;
+
+            do
+            {
+                seed = HashMix(HashRead64(data) ^ HashPrime1, HashRead64(data + 8) ^ seed);
+                seed1 = HashMix(HashRead64(data + 16) ^ HashPrime2, HashRead64(data + 24) ^ seed1);
+                seed2 = HashMix(HashRead64(data + 32) ^ HashPrime3, HashRead64(data + 40) ^ seed2);
+                data += 48;
+                remaining -= 48;
+            }
+            while (remaining > 48);
+
+            seed ^= seed1 ^ seed2;
+        }
+
+        while (remaining > 16)
+        {
+            seed = HashMix(HashRead64(data) ^ HashPrime1, HashRead64(data + 8) ^ seed);
+            data += 16;
+            remaining -= 16;
+        }
+
+        // The last 16 bytes of the input, which may overlap with the already hashed part
+        a = HashRead64(data + remaining - 16);
+        b = HashRead64(data + remaining - 8);
+    }
+
+    a ^= HashPrime1;
+    b ^= seed;
+    HashMultiply(a, b);
+
+    return HashMix(a ^ HashPrime0 ^ aSize, b ^ HashPrime1);
+}
+}
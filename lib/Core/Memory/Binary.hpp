@@ -0,0 +1,142 @@
+#pragma once
+
+namespace Core
+{
+class BinaryWriter
+{
+public:
+    BinaryWriter() = default;
+
+    template<typename T>
+    requires std::is_trivially_copyable_v<T>
+    void Write(const T& aValue)
+    {
+        WriteBytes(&aValue, sizeof(T));
+    }
+
+    void WriteBytes(const void* aData, size_t aSize)
+    {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(aData);
+        m_buffer.insert(m_buffer.end(), bytes, bytes + aSize);
+    }
+
+    void WriteString(std::string_view aValue)
+    {
+        Write(static_cast<uint32_t>(aValue.size()));
+        WriteBytes(aValue.data(), aValue.size());
+    }
+
+    [[nodiscard]] const Core::Vector<uint8_t>& GetBuffer() const
+    {
+        return m_buffer;
+    }
+
+    [[nodiscard]] size_t GetSize() const
+    {
+        return m_buffer.size();
+    }
+
+private:
+    Core::Vector<uint8_t> m_buffer;
+};
+
+class BinaryReader
+{
+public:
+    BinaryReader(const uint8_t* aData, size_t aSize)
+        : m_data(aData)
+        , m_size(aSize)
+        , m_offset(0)
+        , m_failed(false)
+    {
+    }
+
+    template<typename T>
+    requires std::is_trivially_copyable_v<T>
+    T Read()
+    {
+        T value{};
+        ReadBytes(&value, sizeof(T));
+        return value;
+    }
+
+    bool ReadBytes(void* aData, size_t aSize)
+    {
+        if (m_failed || aSize > m_size - m_offset)
+        {
+            m_failed = true;
+            return false;
+        }
+
+        std::memcpy(aData, m_data + m_offset, aSize);
+        m_offset += aSize;
+
+        return true;
+    }
+
+    std::string ReadString()
+    {
+        const auto length = Read<uint32_t>();
+
+        if (m_failed || length > m_size - m_offset)
+        {
+            m_failed = true;
+            return {};
+        }
+
+        std::string value(reinterpret_cast<const char*>(m_data + m_offset), length);
+        m_offset += length;
+
+        return value;
+    }
+
+    const uint8_t* Skip(size_t aSize)
+    {
+        if (m_failed || aSize > m_size - m_offset)
+        {
+            m_failed = true;
+            return nullptr;
+        }
+
+        const auto* data = m_data + m_offset;
+        m_offset += aSize;
+
+        return data;
+    }
+
+    [[nodiscard]] bool IsFailed() const
+    {
+        return m_failed;
+    }
+
+    [[nodiscard]] bool IsEnd() const
+    {
+        return m_offset == m_size;
+    }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_offset;
+    bool m_failed;
+};
+
+// Reads the whole file into the buffer, any failure is reported as false.
+inline bool ReadFile(const std::filesystem::path& aPath, Core::Vector<uint8_t>& aBuffer)
+{
+    std::error_code error;
+    const auto size = std::filesystem::file_size(aPath, error);
+
+    if (error)
+        return false;
+
+    std::ifstream file(aPath, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    aBuffer.resize(size);
+    file.read(reinterpret_cast<char*>(aBuffer.data()), static_cast<std::streamsize>(aBuffer.size()));
+
+    return file.good();
+}
+}
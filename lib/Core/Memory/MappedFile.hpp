@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Core/Win.hpp"
+
+namespace Core
+{
+// Read-only view of a whole file mapped into memory.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+        Close();
+    }
+
+    bool Open(const std::filesystem::path& aPath)
+    {
+        Close();
+
+        m_file = CreateFileW(aPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+        {
+            Close();
+            return false;
+        }
+
+        m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping)
+        {
+            Close();
+            return false;
+        }
+
+        m_data = reinterpret_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!m_data)
+        {
+            Close();
+            return false;
+        }
+
+        m_size = static_cast<size_t>(size.QuadPart);
+
+        return true;
+    }
+
+    void Close()
+    {
+        if (m_data)
+        {
+            UnmapViewOfFile(m_data);
+            m_data = nullptr;
+            m_size = 0;
+        }
+
+        if (m_mapping)
+        {
+            CloseHandle(m_mapping);
+            m_mapping = nullptr;
+        }
+
+        if (m_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_file);
+            m_file = INVALID_HANDLE_VALUE;
+        }
+    }
+
+    [[nodiscard]] bool IsOpen() const
+    {
+        return m_data != nullptr;
+    }
+
+    [[nodiscard]] const uint8_t* GetData() const
+    {
+        return m_data;
+    }
+
+    [[nodiscard]] size_t GetSize() const
+    {
+        return m_size;
+    }
+
+private:
+    HANDLE m_file{INVALID_HANDLE_VALUE};
+    HANDLE m_mapping{nullptr};
+    const uint8_t* m_data{nullptr};
+    size_t m_size{0};
+};
+}
@@ -0,0 +1,70 @@
+#include "MonotonicArena.hpp"
+
+Core::MonotonicArena::MonotonicArena(size_t aBlockSize)
+    : m_blockSize(aBlockSize)
+    , m_cursor(nullptr)
+    , m_end(nullptr)
+    , m_allocated(0)
+    , m_reserved(0)
+{
+}
+
+Core::MonotonicArena::~MonotonicArena()
+{
+    for (const auto& block : m_blocks)
+    {
+        ::operator delete(block.data, std::align_val_t{BlockAlignment});
+    }
+}
+
+void* Core::MonotonicArena::Allocate(size_t aSize, size_t aAlignment)
+{
+    if (aSize == 0)
+    {
+        aSize = 1;
+    }
+
+    // Allocations that would waste a noticeable part of a block get their own block
+    if (aSize > m_blockSize / 4)
+    {
+        m_allocated += aSize;
+        return AllocateBlock(aSize);
+    }
+
+    auto address = reinterpret_cast<uintptr_t>(m_cursor);
+    address = (address + aAlignment - 1) & ~(aAlignment - 1);
+
+    if (!m_cursor || address + aSize > reinterpret_cast<uintptr_t>(m_end))
+    {
+        m_cursor = AllocateBlock(m_blockSize);
+        m_end = m_cursor + m_blockSize;
+
+        address = reinterpret_cast<uintptr_t>(m_cursor);
+        address = (address + aAlignment - 1) & ~(aAlignment - 1);
+    }
+
+    m_cursor = reinterpret_cast<uint8_t*>(address + aSize);
+    m_allocated += aSize;
+
+    return reinterpret_cast<void*>(address);
+}
+
+uint8_t* Core::MonotonicArena::AllocateBlock(size_t aSize)
+{
+    auto* data = static_cast<uint8_t*>(::operator new(aSize, std::align_val_t{BlockAlignment}));
+
+    m_blocks.push_back({data, aSize});
+    m_reserved += aSize;
+
+    return data;
+}
+
+size_t Core::MonotonicArena::GetAllocatedSize() const
+{
+    return m_allocated;
+}
+
+size_t Core::MonotonicArena::GetReservedSize() const
+{
+    return m_reserved;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+namespace Core
+{
+// Hands out memory from large blocks and never frees individual allocations.
+// All blocks are released at once when the arena is destroyed.
+// The arena isn't synchronized and must only be used by one thread at a time.
+class MonotonicArena
+{
+public:
+    static constexpr size_t DefaultBlockSize = 1024 * 1024;
+
+    explicit MonotonicArena(size_t aBlockSize = DefaultBlockSize);
+    ~MonotonicArena();
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    void* Allocate(size_t aSize, size_t aAlignment);
+
+    [[nodiscard]] size_t GetAllocatedSize() const;
+    [[nodiscard]] size_t GetReservedSize() const;
+
+private:
+    struct Block
+    {
+        uint8_t* data;
+        size_t size;
+    };
+
+    uint8_t* AllocateBlock(size_t aSize);
+
+    static constexpr size_t BlockAlignment = 16;
+
+    Vector<Block> m_blocks;
+    size_t m_blockSize;
+    uint8_t* m_cursor;
+    uint8_t* m_end;
+    size_t m_allocated;
+    size_t m_reserved;
+};
+
+// Allocator for standard containers and shared pointers,
+// keeps the arena alive for as long as any memory allocated from it is in use.
+template<typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(SharedPtr<MonotonicArena> aArena) noexcept
+        : m_arena(std::move(aArena))
+    {
+    }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& aOther) noexcept
+        : m_arena(aOther.GetArena())
+    {
+    }
+
+    T* allocate(size_t aCount)
+    {
+        return static_cast<T*>(m_arena->Allocate(aCount * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) noexcept
+    {
+    }
+
+    [[nodiscard]] const SharedPtr<MonotonicArena>& GetArena() const noexcept
+    {
+        return m_arena;
+    }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& aOther) const noexcept
+    {
+        return m_arena == aOther.GetArena();
+    }
+
+private:
+    SharedPtr<MonotonicArena> m_arena;
+};
+}
@@ -0,0 +1,123 @@
+#include "Parallel.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace
+{
+class WorkerPool
+{
+public:
+    explicit WorkerPool(size_t aThreadCount)
+    {
+        m_threads.reserve(aThreadCount);
+
+        for (size_t i = 0; i < aThreadCount; ++i)
+        {
+            m_threads.emplace_back([this]() { Work(); });
+        }
+    }
+
+    void Run(Core::Detail::ParallelJob& aJob)
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_jobs.push_back(&aJob);
+        }
+
+        m_wakeup.notify_all();
+
+        aJob.Run();
+
+        // Once the job is out of the queue no other worker can pick it up,
+        // so it's enough to wait for the ones that are still running it
+        std::unique_lock lock(m_mutex);
+        Dequeue(aJob);
+        m_finished.wait(lock, [&aJob]() { return aJob.activeWorkers == 0; });
+    }
+
+private:
+    void Work()
+    {
+        std::unique_lock lock(m_mutex);
+
+        while (true)
+        {
+            m_wakeup.wait(lock, [this]() { return !m_jobs.empty(); });
+
+            auto* job = m_jobs.front();
+            ++job->activeWorkers;
+
+            lock.unlock();
+            job->Run();
+            lock.lock();
+
+            // All tasks of the job are handed out at this point
+            Dequeue(*job);
+
+            if (--job->activeWorkers == 0)
+            {
+                m_finished.notify_all();
+            }
+        }
+    }
+
+    void Dequeue(Core::Detail::ParallelJob& aJob)
+    {
+        const auto it = std::find(m_jobs.begin(), m_jobs.end(), &aJob);
+
+        if (it != m_jobs.end())
+        {
+            m_jobs.erase(it);
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::condition_variable m_finished;
+    std::deque<Core::Detail::ParallelJob*> m_jobs;
+    Core::Vector<std::thread> m_threads;
+};
+
+size_t GetHardwareThreads()
+{
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+WorkerPool& GetWorkerPool()
+{
+    // The pool is never destroyed, joining threads while the module is unloaded can deadlock
+    static auto* s_pool = new WorkerPool(std::min(GetHardwareThreads() - 1, Core::MaxWorkerThreads));
+    return *s_pool;
+}
+}
+
+size_t Core::GetWorkerCount(size_t aTaskCount)
+{
+    return std::min({GetHardwareThreads(), MaxWorkerThreads + 1, aTaskCount});
+}
+
+void Core::Detail::ParallelJob::Run() noexcept
+{
+    try
+    {
+        for (auto index = nextIndex++; index < count; index = nextIndex++)
+        {
+            invoke(func, index);
+        }
+    }
+    catch (...)
+    {
+        if (!failed.exchange(true))
+        {
+            firstError = std::current_exception();
+        }
+        nextIndex = count;
+    }
+}
+
+void Core::Detail::RunParallelJob(ParallelJob& aJob)
+{
+    GetWorkerPool().Run(aJob);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+namespace Core
+{
+// Upper bound for the worker threads, the calling thread is not counted.
+constexpr size_t MaxWorkerThreads = 15;
+
+size_t GetWorkerCount(size_t aTaskCount);
+
+namespace Detail
+{
+struct ParallelJob
+{
+    void (*invoke)(void* aFunc, size_t aIndex);
+    void* func;
+    size_t count;
+    std::atomic_size_t nextIndex;
+    size_t activeWorkers;
+    std::atomic_bool failed;
+    std::exception_ptr firstError;
+
+    void Run() noexcept;
+};
+
+void RunParallelJob(ParallelJob& aJob);
+}
+
+// Runs the function for every index in [0, count) on a shared pool of worker threads
+// and blocks until all tasks are finished. The calling thread takes part in the work.
+// The pool is started on first use and reused by all later calls, nested calls are allowed.
+// Tasks are handed out one at a time, so the order of execution is not defined.
+// If any task throws, the first exception is rethrown after all tasks are finished.
+template<typename F>
+void ParallelFor(size_t aCount, F&& aFunc)
+{
+    if (aCount == 0)
+        return;
+
+    if (GetWorkerCount(aCount) <= 1)
+    {
+        for (size_t index = 0; index < aCount; ++index)
+        {
+            aFunc(index);
+        }
+        return;
+    }
+
+    using Func = std::remove_reference_t<F>;
+
+    Detail::ParallelJob job{};
+    job.invoke = [](void* aFunc, size_t aIndex) { (*static_cast<Func*>(aFunc))(aIndex); };
+    job.func = const_cast<void*>(static_cast<const void*>(std::addressof(aFunc)));
+    job.count = aCount;
+
+    Detail::RunParallelJob(job);
+
+    if (job.firstError)
+    {
+        std::rethrow_exception(job.firstError);
+    }
+}
+}
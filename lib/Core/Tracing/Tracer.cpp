@@ -0,0 +1,205 @@
+#include "Tracer.hpp"
+
+#include <chrono>
+#include <mutex>
+
+namespace
+{
+constexpr auto SummaryRows = 25;
+
+std::mutex s_eventsLock;
+Core::Vector<Core::Tracer::Event> s_events;
+std::filesystem::path s_outputPath;
+std::atomic_uint32_t s_threadCounter{0};
+
+uint32_t GetThreadIndex()
+{
+    thread_local const uint32_t s_threadIndex = ++s_threadCounter;
+    return s_threadIndex;
+}
+
+void WriteEscaped(std::ofstream& aOut, std::string_view aValue)
+{
+    for (const auto ch : aValue)
+    {
+        switch (ch)
+        {
+        case '"':
+            aOut << "\\\"";
+            break;
+        case '\\':
+            aOut << "\\\\";
+            break;
+        case '\n':
+            aOut << "\\n";
+            break;
+        case '\t':
+            aOut << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20)
+            {
+                aOut << std::format("\\u{:04x}", static_cast<uint32_t>(ch));
+            }
+            else
+            {
+                aOut << ch;
+            }
+        }
+    }
+}
+}
+
+void Core::Tracer::Enable(std::filesystem::path aOutputPath)
+{
+    std::unique_lock _(s_eventsLock);
+    s_outputPath = std::move(aOutputPath);
+    s_enabled.store(true, std::memory_order_relaxed);
+}
+
+void Core::Tracer::Disable()
+{
+    std::unique_lock _(s_eventsLock);
+    s_enabled.store(false, std::memory_order_relaxed);
+    s_events.clear();
+}
+
+int64_t Core::Tracer::GetTimestamp()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void Core::Tracer::Record(const char* aCategory, std::string aName, int64_t aStart, int64_t aEnd)
+{
+    const auto thread = GetThreadIndex();
+
+    std::unique_lock _(s_eventsLock);
+    s_events.push_back({aCategory, std::move(aName), thread, aStart, aEnd - aStart});
+}
+
+void Core::Tracer::Reset()
+{
+    if (!IsEnabled())
+        return;
+
+    std::unique_lock _(s_eventsLock);
+    s_events.clear();
+}
+
+bool Core::Tracer::Flush(Vector<std::string>& aSummary)
+{
+    if (!IsEnabled())
+        return false;
+
+    Vector<Event> events;
+    {
+        std::unique_lock _(s_eventsLock);
+        events = std::move(s_events);
+        s_events.clear();
+    }
+
+    if (events.empty())
+        return false;
+
+    Summarize(events, aSummary);
+
+    return WriteTrace(events);
+}
+
+bool Core::Tracer::WriteTrace(const Vector<Event>& aEvents)
+{
+    if (s_outputPath.empty())
+        return false;
+
+    std::error_code error;
+    std::filesystem::create_directories(s_outputPath.parent_path(), error);
+
+    std::ofstream out(s_outputPath, std::ios::trunc);
+    if (!out.is_open())
+        return false;
+
+    // Events are stored in completion order, so outer scopes come after the ones nested in them
+    const auto origin = std::ranges::min_element(aEvents, {}, &Event::start)->start;
+
+    out << R"({"displayTimeUnit":"ms","traceEvents":[)";
+
+    for (auto i = 0u; i < aEvents.size(); ++i)
+    {
+        const auto& event = aEvents[i];
+
+        if (i > 0)
+        {
+            out << ',';
+        }
+
+        out << R"({"ph":"X","pid":1,"tid":)" << event.thread;
+        out << R"(,"ts":)" << (event.start - origin);
+        out << R"(,"dur":)" << event.duration;
+        out << R"(,"cat":")";
+        WriteEscaped(out, event.category);
+        out << R"(","name":")";
+        WriteEscaped(out, event.name);
+        out << R"("})" << '\n';
+    }
+
+    out << "]}\n";
+
+    return out.good();
+}
+
+void Core::Tracer::Summarize(const Vector<Event>& aEvents, Vector<std::string>& aSummary)
+{
+    struct Stats
+    {
+        std::string_view category;
+        std::string_view name;
+        uint32_t count;
+        int64_t total;
+        int64_t max;
+    };
+
+    Map<std::string, Stats> statsByScope;
+
+    for (const auto& event : aEvents)
+    {
+        auto key = std::format("{}:{}", event.category, event.name);
+        auto it = statsByScope.find(key);
+
+        if (it == statsByScope.end())
+        {
+            statsByScope.emplace(std::move(key), Stats{event.category, event.name, 1, event.duration, event.duration});
+        }
+        else
+        {
+            auto& stats = it.value();
+            ++stats.count;
+            stats.total += event.duration;
+            stats.max = std::max(stats.max, event.duration);
+        }
+    }
+
+    Vector<Stats> sortedStats;
+    sortedStats.reserve(statsByScope.size());
+
+    for (const auto& [_, stats] : statsByScope)
+    {
+        sortedStats.push_back(stats);
+    }
+
+    std::ranges::sort(sortedStats, [](const Stats& aLeft, const Stats& aRight) {
+        return aLeft.total > aRight.total;
+    });
+
+    aSummary.push_back(std::format("{:<10} {:<60} {:>8} {:>11} {:>11}", "Category", "Scope", "Calls", "Total, ms",
+                                   "Max, ms"));
+
+    for (auto i = 0u; i < sortedStats.size() && i < SummaryRows; ++i)
+    {
+        const auto& stats = sortedStats[i];
+        aSummary.push_back(std::format("{:<10} {:<60} {:>8} {:>11.2f} {:>11.2f}", stats.category, stats.name,
+                                       stats.count, static_cast<double>(stats.total) / 1000.0,
+                                       static_cast<double>(stats.max) / 1000.0));
+    }
+}
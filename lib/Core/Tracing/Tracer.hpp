@@ -0,0 +1,140 @@
+#pragma once
+
+namespace Core
+{
+// Collects timed events while enabled. When disabled, every scope costs a single relaxed load.
+class Tracer
+{
+public:
+    struct Event
+    {
+        const char* category;
+        std::string name;
+        uint32_t thread;
+        int64_t start;
+        int64_t duration;
+    };
+
+    static void Enable(std::filesystem::path aOutputPath);
+    static void Disable();
+
+    inline static bool IsEnabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    static int64_t GetTimestamp();
+    static void Record(const char* aCategory, std::string aName, int64_t aStart, int64_t aEnd);
+
+    static void Reset();
+    static bool Flush(Vector<std::string>& aSummary);
+
+private:
+    static bool WriteTrace(const Vector<Event>& aEvents);
+    static void Summarize(const Vector<Event>& aEvents, Vector<std::string>& aSummary);
+
+    inline static std::atomic_bool s_enabled{false};
+};
+
+class TraceScope
+{
+public:
+    TraceScope(const char* aCategory, const char* aName)
+        : m_active(Tracer::IsEnabled())
+    {
+        if (m_active)
+        {
+            m_category = aCategory;
+            m_name = aName;
+            m_start = Tracer::GetTimestamp();
+        }
+    }
+
+    // The name is only built when tracing is enabled.
+    template<typename F>
+    requires std::is_invocable_r_v<std::string, F>
+    TraceScope(const char* aCategory, F&& aNameBuilder)
+        : m_active(Tracer::IsEnabled())
+    {
+        if (m_active)
+        {
+            m_category = aCategory;
+            m_name = aNameBuilder();
+            m_start = Tracer::GetTimestamp();
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    ~TraceScope()
+    {
+        End();
+    }
+
+    void End()
+    {
+        if (m_active)
+        {
+            Tracer::Record(m_category, std::move(m_name), m_start, Tracer::GetTimestamp());
+            m_active = false;
+        }
+    }
+
+private:
+    bool m_active;
+    const char* m_category{nullptr};
+    std::string m_name;
+    int64_t m_start{0};
+};
+
+// Times consecutive steps of a single procedure, each step ends when the next one begins.
+class TraceSequence
+{
+public:
+    explicit TraceSequence(const char* aCategory)
+        : m_active(Tracer::IsEnabled())
+        , m_category(aCategory)
+    {
+    }
+
+    TraceSequence(const TraceSequence&) = delete;
+    TraceSequence& operator=(const TraceSequence&) = delete;
+
+    ~TraceSequence()
+    {
+        End();
+    }
+
+    void Next(const char* aName)
+    {
+        if (m_active)
+        {
+            const auto now = Tracer::GetTimestamp();
+
+            if (m_name)
+            {
+                Tracer::Record(m_category, m_name, m_start, now);
+            }
+
+            m_name = aName;
+            m_start = now;
+        }
+    }
+
+    void End()
+    {
+        if (m_active && m_name)
+        {
+            Tracer::Record(m_category, m_name, m_start, Tracer::GetTimestamp());
+            m_name = nullptr;
+        }
+    }
+
+private:
+    bool m_active;
+    const char* m_category;
+    const char* m_name{nullptr};
+    int64_t m_start{0};
+};
+}
@@ -5,6 +5,7 @@
 #include "App/Stats/StatService.hpp"
 #include "App/Tweaks/TweakService.hpp"
 #include "Core/Foundation/RuntimeProvider.hpp"
+#include "Core/Tracing/Tracer.hpp"
 #include "Support/MinHook/MinHookProvider.hpp"
 #include "Support/RED4ext/RED4extProvider.hpp"
 #include "Support/RedLib/RedLibProvider.hpp"
@@ -26,7 +27,7 @@ App::Application::Application(HMODULE aHandle, const RED4ext::Sdk* aSdk)
 
     Register<App::TweakService>(Env::GameVer(), Env::GameDir(), Env::TweaksDir(),
                                 Env::InheritanceMapPath(), Env::ExtraFlatsPath(),
-                                Env::RedModSourcesDir());
+                                Env::RedModSourcesDir(), Env::TweaksCacheDir());
     Register<App::StatService>();
 }
 
@@ -35,4 +36,10 @@ void App::Application::OnStarting()
     LogInfo("{} {} is starting...", Project::Name, Project::Version.to_string());
 
     Migration::CleanUp(Env::LegacyScriptsDir());
+
+    if (Env::IsTracingRequested())
+    {
+        LogInfo("Import tracing is enabled, the trace will be saved to \"{}\".", Env::TraceFilePath().string());
+        Core::Tracer::Enable(Env::TraceFilePath());
+    }
 }
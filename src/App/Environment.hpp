@@ -14,6 +14,21 @@ inline auto TweaksDir()
     return GameDir() / L"r6" / L"tweaks";
 }
 
+inline auto TweaksCacheDir()
+{
+    return GameDir() / L"r6" / L"cache" / L"tweakxl";
+}
+
+inline auto TraceFilePath()
+{
+    return TweaksCacheDir() / L"import.trace.json";
+}
+
+inline bool IsTracingRequested()
+{
+    return GetEnvironmentVariableW(L"TWEAKXL_TRACE", nullptr, 0) > 0;
+}
+
 inline auto RedModSourcesDir()
 {
     return GameDir() / L"tools" / L"redmod" / L"tweaks";
@@ -49,6 +49,66 @@ void App::Facade::Reload()
     Core::Resolve<TweakService>()->LoadTweaks(true);
 }
 
+void App::Facade::ReloadChanged()
+{
+    Core::Resolve<TweakService>()->LoadChangedTweaks(true);
+}
+
+App::BufferStats App::Facade::GetBufferStats()
+{
+    auto& manager = Core::Resolve<TweakService>()->GetManager();
+
+    const auto stats = manager.GetBufferStats();
+
+    BufferStats result{};
+    result.totalSize = stats.poolSize;
+    result.baseSize = stats.baseSize;
+    result.addedSize = stats.addedSize;
+    result.snapshotSize = stats.snapshotSize;
+    result.poolValues = stats.poolValues;
+    result.flatEntries = stats.flatEntries;
+    result.allocations = stats.allocations;
+    result.allocationHits = stats.allocationHits;
+    result.poolLoadFactor = stats.poolLoadFactor;
+
+    const auto commitStats = manager.GetCommitStats();
+
+    result.lastCommitTime = commitStats.commitTime;
+    result.lastCommitLockTime = commitStats.lockTime;
+    result.lastCommitAssignedFlats = commitStats.assignedFlats;
+    result.lastCommitInsertedFlats = commitStats.insertedFlats;
+
+    for (const auto& typeStats : manager.CollectBufferTypeStats())
+    {
+        result.types.PushBack({typeStats.typeName, typeStats.values, typeStats.bytes, typeStats.addedValues,
+                               typeStats.addedBytes, typeStats.poolValues, typeStats.poolLoadFactor});
+    }
+
+    return result;
+}
+
+void App::Facade::DumpBufferStats()
+{
+    Core::Resolve<TweakService>()->DumpBufferStats();
+}
+
+Red::DynArray<Red::TweakDBID> App::Facade::GetReferences(Red::TweakDBID aId)
+{
+    Red::DynArray<Red::TweakDBID> result;
+
+    for (const auto& flatId : Core::Resolve<TweakService>()->GetManager().GetReferences(aId))
+    {
+        result.PushBack(flatId);
+    }
+
+    return result;
+}
+
+bool App::Facade::CompileBundle(Red::CString& aSourcePath, Red::CString& aBundlePath)
+{
+    return Core::Resolve<TweakService>()->CompileBundle(aSourcePath.c_str(), aBundlePath.c_str());
+}
+
 bool App::Facade::Require(Red::CString& aVersion)
 {
     const auto requirement = semver::from_string_noexcept(aVersion.c_str());
@@ -4,6 +4,35 @@
 
 namespace App
 {
+struct BufferTypeStats
+{
+    Red::CName typeName;
+    uint64_t values;
+    uint64_t bytes;
+    uint64_t addedValues;
+    uint64_t addedBytes;
+    uint64_t poolValues;
+    float poolLoadFactor;
+};
+
+struct BufferStats
+{
+    uint64_t totalSize;
+    uint64_t baseSize;
+    uint64_t addedSize;
+    uint64_t snapshotSize;
+    uint64_t poolValues;
+    uint64_t flatEntries;
+    uint64_t allocations;
+    uint64_t allocationHits;
+    float poolLoadFactor;
+    float lastCommitTime;
+    float lastCommitLockTime;
+    uint64_t lastCommitAssignedFlats;
+    uint64_t lastCommitInsertedFlats;
+    Red::DynArray<BufferTypeStats> types;
+};
+
 class Facade : public Red::IScriptable
 {
 public:
@@ -16,6 +45,11 @@ public:
     static void ExecuteTweak(Red::CName aName);
     static void ExportMetadata();
     static void Reload();
+    static void ReloadChanged();
+    static BufferStats GetBufferStats();
+    static void DumpBufferStats();
+    static Red::DynArray<Red::TweakDBID> GetReferences(Red::TweakDBID aId);
+    static bool CompileBundle(Red::CString& aSourcePath, Red::CString& aBundlePath);
     static bool Require(Red::CString& aVersion);
     static Red::CString GetVersion();
 
@@ -23,6 +57,33 @@ public:
 };
 }
 
+RTTI_DEFINE_CLASS(App::BufferTypeStats, "TweakXLBufferTypeStats", {
+    RTTI_PROPERTY(typeName);
+    RTTI_PROPERTY(values);
+    RTTI_PROPERTY(bytes);
+    RTTI_PROPERTY(addedValues);
+    RTTI_PROPERTY(addedBytes);
+    RTTI_PROPERTY(poolValues);
+    RTTI_PROPERTY(poolLoadFactor);
+})
+
+RTTI_DEFINE_CLASS(App::BufferStats, "TweakXLBufferStats", {
+    RTTI_PROPERTY(totalSize);
+    RTTI_PROPERTY(baseSize);
+    RTTI_PROPERTY(addedSize);
+    RTTI_PROPERTY(snapshotSize);
+    RTTI_PROPERTY(poolValues);
+    RTTI_PROPERTY(flatEntries);
+    RTTI_PROPERTY(allocations);
+    RTTI_PROPERTY(allocationHits);
+    RTTI_PROPERTY(poolLoadFactor);
+    RTTI_PROPERTY(lastCommitTime);
+    RTTI_PROPERTY(lastCommitLockTime);
+    RTTI_PROPERTY(lastCommitAssignedFlats);
+    RTTI_PROPERTY(lastCommitInsertedFlats);
+    RTTI_PROPERTY(types);
+})
+
 RTTI_DEFINE_CLASS(App::Facade, App::Project::Name, {
     RTTI_ABSTRACT();
     RTTI_METHOD(RegisterDir);
@@ -34,6 +95,11 @@ RTTI_DEFINE_CLASS(App::Facade, App::Project::Name, {
     RTTI_METHOD(ExecuteTweak, "Execute");
     RTTI_METHOD(ExportMetadata);
     RTTI_METHOD(Reload);
+    RTTI_METHOD(ReloadChanged);
+    RTTI_METHOD(GetBufferStats);
+    RTTI_METHOD(DumpBufferStats);
+    RTTI_METHOD(GetReferences);
+    RTTI_METHOD(CompileBundle);
     RTTI_METHOD(Require);
     RTTI_METHOD(GetVersion, "Version");
 })
@@ -6,6 +6,19 @@ bool App::TweakChangelog::RegisterRecord(Red::TweakDBID aRecordId)
     if (!aRecordId.IsValid())
         return false;
 
+    m_records.insert(aRecordId);
+    m_createdRecords.insert(aRecordId);
+
+    return true;
+}
+
+bool App::TweakChangelog::ReclaimRecord(Red::TweakDBID aRecordId)
+{
+    // Records can't be removed from the database, so a reverted record still exists
+    // when the tweak that created it is applied again.
+    if (!m_createdRecords.contains(aRecordId))
+        return false;
+
     m_records.insert(aRecordId);
 
     return true;
@@ -85,6 +98,21 @@ void App::TweakChangelog::ForgetForeignKeys()
     m_foreignKeys.clear();
 }
 
+void App::TweakChangelog::ForgetForeignKeys(const Core::Set<Red::TweakDBID>& aFlatIds)
+{
+    for (auto it = m_foreignKeys.begin(); it != m_foreignKeys.end();)
+    {
+        if (aFlatIds.contains(it->second))
+        {
+            it = m_foreignKeys.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
 void App::TweakChangelog::RegisterResourcePath(Red::ResourcePath aPath, Red::TweakDBID aFlatId)
 {
     if (aPath)
@@ -106,180 +134,264 @@ void App::TweakChangelog::ForgetResourcePaths()
     m_resourcePaths.clear();
 }
 
+void App::TweakChangelog::ForgetResourcePaths(const Core::Set<Red::TweakDBID>& aFlatIds)
+{
+    for (auto it = m_resourcePaths.begin(); it != m_resourcePaths.end();)
+    {
+        if (aFlatIds.contains(it->second))
+        {
+            it = m_resourcePaths.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
 void App::TweakChangelog::CheckForIssues(const Core::SharedPtr<Red::TweakDBManager>& aManager)
 {
     {
-        Core::Map<Red::TweakDBID, Core::Set<Red::TweakDBID>> brokenRefs;
+        Core::Vector<Red::TweakDBID> foreignKeys;
+        foreignKeys.reserve(m_foreignKeys.size());
 
-        for (const auto& [foreignKey, flatId] : m_foreignKeys)
+        for (const auto& [foreignKey, _] : m_foreignKeys)
         {
-            if (!aManager->IsRecordExists(foreignKey) && !aManager->IsFlatExists(foreignKey))
-            {
-                brokenRefs[flatId].insert(foreignKey);
-            }
+            foreignKeys.push_back(foreignKey);
         }
 
-        for (const auto& [flatId, foreignKeys] : brokenRefs)
+        // Names are copied, since the views returned by the manager don't survive new name lookups
+        Core::Vector<std::pair<std::string, std::string>> brokenRefs;
+
+        for (const auto& foreignKey : aManager->FindMissing(std::move(foreignKeys)))
         {
-            const auto& flatName = aManager->GetName(flatId);
+            std::string flatName{aManager->GetName(m_foreignKeys[foreignKey])};
             if (!flatName.starts_with(Red::TweakSource::SchemaPackage))
             {
-                for (const auto& foreignKey : foreignKeys)
-                {
-                    const auto& foreignKeyName = aManager->GetName(foreignKey);
-                    LogWarning("{} refers to a non-existent record or flat {}.", flatName, foreignKeyName);
-                }
+                brokenRefs.emplace_back(std::move(flatName), aManager->GetName(foreignKey));
             }
         }
+
+        std::ranges::sort(brokenRefs);
+
+        for (const auto& [flatName, foreignKeyName] : brokenRefs)
+        {
+            LogWarning("{} refers to a non-existent record or flat {}.", flatName, foreignKeyName);
+        }
     }
 
     {
-        Core::Set<Red::TweakDBID> brokenRefIds;
-
+        // The depot isn't known to be safe to query from other threads, so the paths are checked in place
         auto depot = Red::ResourceDepot::Get();
+
+        Core::Vector<std::string> brokenRefs;
+
         for (const auto& [resourcePath, flatId] : m_resourcePaths)
         {
             if (!depot->ResourceExists(resourcePath))
             {
-                brokenRefIds.insert(flatId);
+                brokenRefs.emplace_back(aManager->GetName(flatId));
             }
         }
 
-        for (const auto& flatId : brokenRefIds)
+        std::ranges::sort(brokenRefs);
+        brokenRefs.erase(std::unique(brokenRefs.begin(), brokenRefs.end()), brokenRefs.end());
+
+        for (const auto& flatName : brokenRefs)
         {
-            LogWarning("{} refers to a non-existent resource.", aManager->GetName(flatId));
+            LogWarning("{} refers to a non-existent resource.", flatName);
         }
     }
 }
 
 void App::TweakChangelog::RevertChanges(const Core::SharedPtr<Red::TweakDBManager>& aManager)
 {
-    Core::Set<Red::TweakDBID> updates;
-
     for (const auto& [flatId, mutation] : m_mutations)
     {
-        const auto& flatData = aManager->GetFlat(flatId);
+        RevertMutation(aManager, flatId, mutation);
+    }
+
+    for (const auto& [flatId, assignment] : m_assignments)
+    {
+        RevertAssignment(aManager, flatId, assignment);
+    }
+
+    for (const auto recordId : m_records)
+    {
+        const auto success = aManager->UpdateRecord(recordId);
 
-        if (!flatData.instance)
+        if (!success)
         {
-            LogWarning("Cannot restore {}, the flat doesn't exist.", aManager->GetName(flatId));
-            continue;
+            LogError("Cannot restore {}, failed to update the record.", aManager->GetName(recordId));
         }
+    }
+
+    m_records.clear();
+    m_assignments.clear();
+    m_mutations.clear();
+}
 
-        if (flatData.type->GetType() != Red::ERTTIType::Array)
+void App::TweakChangelog::RevertChanges(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                        const Core::Set<Red::TweakDBID>& aFlatIds,
+                                        const Core::Set<Red::TweakDBID>& aRecordIds)
+{
+    for (const auto& flatId : aFlatIds)
+    {
+        const auto mutationIt = m_mutations.find(flatId);
+        if (mutationIt != m_mutations.end())
         {
-            LogWarning("Cannot restore {}, it's not an array.", aManager->GetName(flatId));
-            continue;
+            RevertMutation(aManager, flatId, mutationIt->second);
+            m_mutations.erase(mutationIt);
         }
 
-        auto arrayType = reinterpret_cast<const Red::CRTTIArrayType*>(flatData.type);
-        auto elementType = arrayType->innerType;
-        auto canRestore = true;
-
+        const auto assignmentIt = m_assignments.find(flatId);
+        if (assignmentIt != m_assignments.end())
         {
-            auto currentArray = flatData.instance;
-            auto currentSize = arrayType->GetLength(currentArray);
+            RevertAssignment(aManager, flatId, assignmentIt->second);
+            m_assignments.erase(assignmentIt);
+        }
+    }
 
-            for (const auto& [insertionIndex, insertionValue] : mutation.insertions)
-            {
-                if (insertionIndex >= currentSize)
-                {
-                    canRestore = false;
-                    break;
-                }
-
-                auto currentElement = arrayType->GetElement(currentArray, insertionIndex);
-
-                if (!elementType->IsEqual(currentElement, insertionValue.get()))
-                {
-                    canRestore = false;
-                    break;
-                }
-            }
+    for (const auto recordId : aRecordIds)
+    {
+        m_records.erase(recordId);
 
-            currentSize -= mutation.insertions.size();
-            currentSize += mutation.deletions.size();
+        if (!aManager->IsRecordExists(recordId))
+            continue;
 
-            for (const auto& [deletionIndex, deletionValue] : mutation.deletions)
-            {
-                if (deletionIndex >= currentSize)
-                {
-                    canRestore = false;
-                    break;
-                }
-            }
-        }
+        const auto success = aManager->UpdateRecord(recordId);
 
-        if (!canRestore)
+        if (!success)
         {
-            LogWarning("Cannot restore {}, third party changes detected.", aManager->GetName(flatId));
-            continue;
+            LogError("Cannot restore {}, failed to update the record.", aManager->GetName(recordId));
         }
+    }
+}
 
-        auto restoredArray = aManager->GetReflection()->Construct(arrayType);
-        arrayType->Assign(restoredArray.get(), flatData.instance);
+void App::TweakChangelog::RevertMutation(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                         Red::TweakDBID aFlatId, const MutationEntry& aMutation)
+{
+    const auto& flatData = aManager->GetFlat(aFlatId);
 
-        for (const auto& [insertionIndex, insertionValue] : mutation.insertions | std::views::reverse)
-        {
-            arrayType->RemoveAt(restoredArray.get(), insertionIndex);
-        }
+    if (!flatData.instance)
+    {
+        LogWarning("Cannot restore {}, the flat doesn't exist.", aManager->GetName(aFlatId));
+        return;
+    }
 
-        for (const auto& [deletionIndex, deletionValue] : mutation.deletions)
+    if (flatData.type->GetType() != Red::ERTTIType::Array)
+    {
+        LogWarning("Cannot restore {}, it's not an array.", aManager->GetName(aFlatId));
+        return;
+    }
+
+    auto arrayType = reinterpret_cast<const Red::CRTTIArrayType*>(flatData.type);
+    auto elementType = arrayType->innerType;
+    auto canRestore = true;
+
+    {
+        auto currentArray = flatData.instance;
+        auto currentSize = arrayType->GetLength(currentArray);
+
+        for (const auto& [insertionIndex, insertionValue] : aMutation.insertions)
         {
-            arrayType->InsertAt(restoredArray.get(), deletionIndex);
-            elementType->Assign(arrayType->GetElement(restoredArray.get(), deletionIndex), deletionValue.get());
+            if (insertionIndex >= currentSize)
+            {
+                canRestore = false;
+                break;
+            }
+
+            auto currentElement = arrayType->GetElement(currentArray, insertionIndex);
+
+            if (!elementType->IsEqual(currentElement, insertionValue.get()))
+            {
+                canRestore = false;
+                break;
+            }
         }
 
-        const auto success = aManager->SetFlat(flatId, arrayType, restoredArray.get());
+        currentSize -= aMutation.insertions.size();
+        currentSize += aMutation.deletions.size();
 
-        if (!success)
+        for (const auto& [deletionIndex, deletionValue] : aMutation.deletions)
         {
-            LogError("Cannot restore {}, failed to assign the value.", aManager->GetName(flatId));
-            continue;
+            if (deletionIndex >= currentSize)
+            {
+                canRestore = false;
+                break;
+            }
         }
     }
 
-    for (const auto& [flatId, assignment] : m_assignments)
+    if (!canRestore)
     {
-        const auto& flatData = aManager->GetFlat(flatId);
+        LogWarning("Cannot restore {}, third party changes detected.", aManager->GetName(aFlatId));
+        return;
+    }
 
-        if (!flatData.instance)
-        {
-            LogWarning("Cannot restore {}, the flat doesn't exist.", aManager->GetName(flatId));
-            continue;
-        }
+    auto restoredArray = aManager->GetReflection()->Construct(arrayType);
+    arrayType->Assign(restoredArray.get(), flatData.instance);
 
-        if (!m_ownedKeys.contains(flatId) && flatData.instance != assignment.current)
-        {
-            LogWarning("Cannot restore {}, third party changes detected.", aManager->GetName(flatId));
-            continue;
-        }
+    for (const auto& [insertionIndex, insertionValue] : aMutation.insertions | std::views::reverse)
+    {
+        arrayType->RemoveAt(restoredArray.get(), insertionIndex);
+    }
 
-        const auto success = aManager->SetFlat(flatId, flatData.type, assignment.previous);
+    for (const auto& [deletionIndex, deletionValue] : aMutation.deletions)
+    {
+        arrayType->InsertAt(restoredArray.get(), deletionIndex);
+        elementType->Assign(arrayType->GetElement(restoredArray.get(), deletionIndex), deletionValue.get());
+    }
 
-        if (!success)
-        {
-            LogError("Cannot restore {}, failed to assign the value.", aManager->GetName(flatId));
-            continue;
-        }
+    const auto success = aManager->SetFlat(aFlatId, arrayType, restoredArray.get());
+
+    if (!success)
+    {
+        LogError("Cannot restore {}, failed to assign the value.", aManager->GetName(aFlatId));
     }
+}
 
-    for (const auto recordId : m_records)
+void App::TweakChangelog::RevertAssignment(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                           Red::TweakDBID aFlatId, const AssignmentEntry& aAssignment)
+{
+    const auto& flatData = aManager->GetFlat(aFlatId);
+
+    if (!flatData.instance)
     {
-        const auto success = aManager->UpdateRecord(recordId);
+        LogWarning("Cannot restore {}, the flat doesn't exist.", aManager->GetName(aFlatId));
+        return;
+    }
 
-        if (!success)
-        {
-            LogError("Cannot restore {}, failed to update the record.", aManager->GetName(recordId));
-        }
+    if (!m_ownedKeys.contains(aFlatId) && flatData.instance != aAssignment.current)
+    {
+        LogWarning("Cannot restore {}, third party changes detected.", aManager->GetName(aFlatId));
+        return;
     }
 
-    m_records.clear();
-    m_assignments.clear();
-    m_mutations.clear();
+    const auto success = aManager->SetFlat(aFlatId, flatData.type, aAssignment.previous);
+
+    if (!success)
+    {
+        LogError("Cannot restore {}, failed to assign the value.", aManager->GetName(aFlatId));
+    }
 }
 
 const Core::Set<Red::TweakDBID>& App::TweakChangelog::GetAffectedRecords() const
 {
     return m_records;
 }
+
+Core::Vector<Red::Instance*> App::TweakChangelog::GetValueRefs()
+{
+    // Assignments keep pointers to the buffer values, so they have to be updated when the buffer is compacted
+    Core::Vector<Red::Instance*> refs;
+    refs.reserve(m_assignments.size() * 2);
+
+    for (auto it = m_assignments.begin(); it != m_assignments.end(); ++it)
+    {
+        refs.push_back(&it.value().previous);
+        refs.push_back(&it.value().current);
+    }
+
+    return refs;
+}
@@ -9,6 +9,7 @@ class TweakChangelog : public Core::LoggingAgent
 {
 public:
     bool RegisterRecord(Red::TweakDBID aRecordId);
+    bool ReclaimRecord(Red::TweakDBID aRecordId);
 
     bool RegisterAssignment(Red::TweakDBID aFlatId, Red::Instance aOldValue, Red::Instance aNewValue);
     bool RegisterInsertion(Red::TweakDBID aFlatId, int32_t aIndex, const Red::InstancePtr<>& aInstance);
@@ -18,15 +19,20 @@ public:
     void RegisterForeignKey(Red::TweakDBID aForeignKey, Red::TweakDBID aFlatId);
     void ForgetForeignKey(Red::TweakDBID aForeignKey);
     void ForgetForeignKeys();
+    void ForgetForeignKeys(const Core::Set<Red::TweakDBID>& aFlatIds);
 
     void RegisterResourcePath(Red::ResourcePath aPath, Red::TweakDBID aFlatId);
     void ForgetResourcePath(Red::ResourcePath aPath);
     void ForgetResourcePaths();
+    void ForgetResourcePaths(const Core::Set<Red::TweakDBID>& aFlatIds);
 
     void CheckForIssues(const Core::SharedPtr<Red::TweakDBManager>& aManager);
     void RevertChanges(const Core::SharedPtr<Red::TweakDBManager>& aManager);
+    void RevertChanges(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                       const Core::Set<Red::TweakDBID>& aFlatIds, const Core::Set<Red::TweakDBID>& aRecordIds);
 
     [[nodiscard]] const Core::Set<Red::TweakDBID>& GetAffectedRecords() const;
+    [[nodiscard]] Core::Vector<Red::Instance*> GetValueRefs();
 
 private:
     struct AssignmentEntry
@@ -41,7 +47,13 @@ private:
         Core::SortedMap<int32_t, Red::InstancePtr<>> deletions;
     };
 
+    void RevertMutation(const Core::SharedPtr<Red::TweakDBManager>& aManager, Red::TweakDBID aFlatId,
+                        const MutationEntry& aMutation);
+    void RevertAssignment(const Core::SharedPtr<Red::TweakDBManager>& aManager, Red::TweakDBID aFlatId,
+                          const AssignmentEntry& aAssignment);
+
     Core::Set<Red::TweakDBID> m_records;
+    Core::Set<Red::TweakDBID> m_createdRecords;
     Core::Map<Red::TweakDBID, AssignmentEntry> m_assignments;
     Core::Map<Red::TweakDBID, MutationEntry> m_mutations;
     Core::Map<Red::TweakDBID, Red::TweakDBID> m_foreignKeys;
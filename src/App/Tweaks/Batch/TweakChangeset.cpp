@@ -1,8 +1,54 @@
 #include "TweakChangeset.hpp"
+#include "Core/Threading/Parallel.hpp"
+#include "Core/Tracing/Tracer.hpp"
 
 namespace
 {
 constexpr auto StringTypeName = Red::GetTypeName<Red::CString>();
+
+// Hash index of array element values with an equality check on lookup.
+class ElementIndex
+{
+public:
+    explicit ElementIndex(Red::CBaseRTTIType* aType)
+        : m_type(aType)
+    {
+    }
+
+    void Add(void* aValue, int32_t aIndex = 0)
+    {
+        auto& bucket = m_buckets[Red::TweakDBBuffer::ComputeHash(m_type, aValue)];
+
+        // Keep only the first occurrence of equal values
+        for (const auto& [value, index] : bucket)
+        {
+            if (m_type->IsEqual(value, aValue))
+                return;
+        }
+
+        bucket.emplace_back(aValue, aIndex);
+    }
+
+    [[nodiscard]] int32_t Find(void* aValue) const
+    {
+        const auto it = m_buckets.find(Red::TweakDBBuffer::ComputeHash(m_type, aValue));
+
+        if (it == m_buckets.end())
+            return -1;
+
+        for (const auto& [value, index] : it->second)
+        {
+            if (m_type->IsEqual(value, aValue))
+                return index;
+        }
+
+        return -1;
+    }
+
+private:
+    Red::CBaseRTTIType* m_type;
+    Core::Map<uint64_t, Core::Vector<std::pair<void*, int32_t>>> m_buckets;
+};
 }
 
 bool App::TweakChangeset::SetFlat(Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType,
@@ -15,6 +61,11 @@ bool App::TweakChangeset::SetFlat(Red::TweakDBID aFlatId, const Red::CBaseRTTITy
     entry.type = aType;
     entry.value = aValue;
 
+    if (m_recording)
+    {
+        m_recording->AddOperation({TweakFragment::OperationType::SetFlat, aFlatId, {}, aType, aValue});
+    }
+
     return true;
 }
 
@@ -27,6 +78,12 @@ bool App::TweakChangeset::ReinheritFlat(Red::TweakDBID aFlatId, Red::TweakDBID a
     entry.sourceId = aSourceId;
     entry.appendix = aAppendix;
 
+    if (m_recording)
+    {
+        m_recording->AddOperation({TweakFragment::OperationType::ReinheritFlat, aFlatId, aSourceId,
+                                   nullptr, nullptr, aAppendix});
+    }
+
     return true;
 }
 
@@ -46,6 +103,11 @@ bool App::TweakChangeset::MakeRecord(Red::TweakDBID aRecordId, const Red::CClass
         m_orderedRecords.push_back(aRecordId);
     }
 
+    if (m_recording)
+    {
+        m_recording->AddOperation({TweakFragment::OperationType::MakeRecord, aRecordId, aSourceId, aType});
+    }
+
     return true;
 }
 
@@ -60,6 +122,11 @@ bool App::TweakChangeset::UpdateRecord(Red::TweakDBID aRecordId)
         m_orderedRecords.push_back(aRecordId);
     }
 
+    if (m_recording)
+    {
+        m_recording->AddOperation({TweakFragment::OperationType::UpdateRecord, aRecordId});
+    }
+
     return true;
 }
 
@@ -69,9 +136,15 @@ bool App::TweakChangeset::AppendElement(Red::TweakDBID aFlatId, const Red::CBase
     if (!aFlatId.IsValid() || !aType || !aValue)
         return false;
 
-    auto& entry = m_pendingMutations[aFlatId];
+    auto& entry = GetMutation(aFlatId);
     entry.appendings.emplace_back(aType, aValue, aUnique);
 
+    if (m_recording)
+    {
+        m_recording->AddOperation({TweakFragment::OperationType::AppendElement, aFlatId, {},
+                                   aType, aValue, {}, aUnique});
+    }
+
     return true;
 }
 
@@ -81,9 +154,15 @@ bool App::TweakChangeset::PrependElement(Red::TweakDBID aFlatId, const Red::CBas
     if (!aFlatId.IsValid() || !aType || !aValue)
         return false;
 
-    auto& entry = m_pendingMutations[aFlatId];
+    auto& entry = GetMutation(aFlatId);
     entry.prependings.emplace_back(aType, aValue, aUnique);
 
+    if (m_recording)
+    {
+        m_recording->AddOperation({TweakFragment::OperationType::PrependElement, aFlatId, {},
+                                   aType, aValue, {}, aUnique});
+    }
+
     return true;
 }
 
@@ -93,9 +172,14 @@ bool App::TweakChangeset::RemoveElement(Red::TweakDBID aFlatId, const Red::CBase
     if (!aFlatId.IsValid() || !aType || !aValue)
         return false;
 
-    auto& entry = m_pendingMutations[aFlatId];
+    auto& entry = GetMutation(aFlatId);
     entry.deletions.emplace_back(aType, aValue);
 
+    if (m_recording)
+    {
+        m_recording->AddOperation({TweakFragment::OperationType::RemoveElement, aFlatId, {}, aType, aValue});
+    }
+
     return true;
 }
 
@@ -104,9 +188,14 @@ bool App::TweakChangeset::RemoveAllElements(Red::TweakDBID aFlatId)
     if (!aFlatId.IsValid())
         return false;
 
-    auto& entry = m_pendingMutations[aFlatId];
+    auto& entry = GetMutation(aFlatId);
     entry.deleteAll = true;
 
+    if (m_recording)
+    {
+        m_recording->AddOperation({TweakFragment::OperationType::RemoveAllElements, aFlatId});
+    }
+
     return true;
 }
 
@@ -115,9 +204,14 @@ bool App::TweakChangeset::AppendFrom(Red::TweakDBID aFlatId, Red::TweakDBID aSou
     if (!aFlatId.IsValid() || !aSourceId.IsValid())
         return false;
 
-    auto& entry = m_pendingMutations[aFlatId];
+    auto& entry = GetMutation(aFlatId);
     entry.appendingMerges.emplace_back(aSourceId);
 
+    if (m_recording)
+    {
+        m_recording->AddOperation({TweakFragment::OperationType::AppendFrom, aFlatId, aSourceId});
+    }
+
     return true;
 }
 
@@ -126,9 +220,14 @@ bool App::TweakChangeset::PrependFrom(Red::TweakDBID aFlatId, Red::TweakDBID aSo
     if (!aFlatId.IsValid() || !aSourceId.IsValid())
         return false;
 
-    auto& entry = m_pendingMutations[aFlatId];
+    auto& entry = GetMutation(aFlatId);
     entry.prependingMerges.emplace_back(aSourceId);
 
+    if (m_recording)
+    {
+        m_recording->AddOperation({TweakFragment::OperationType::PrependFrom, aFlatId, aSourceId});
+    }
+
     return true;
 }
 
@@ -136,6 +235,11 @@ bool App::TweakChangeset::RegisterName(Red::TweakDBID aId, const std::string& aN
 {
     m_pendingNames[aId] = aName;
 
+    if (m_recording)
+    {
+        m_recording->AddOperation({TweakFragment::OperationType::RegisterName, aId, {}, nullptr, nullptr, aName});
+    }
+
     return true;
 }
 
@@ -174,6 +278,32 @@ bool App::TweakChangeset::HasRecord(Red::TweakDBID aRecordId)
     return m_pendingRecords.find(aRecordId) != m_pendingRecords.end();
 }
 
+void App::TweakChangeset::TrackFlatLookup(Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType)
+{
+    if (m_recording)
+    {
+        m_recording->AddFlatExpectation(aFlatId, aType);
+    }
+}
+
+void App::TweakChangeset::TrackRecordLookup(Red::TweakDBID aRecordId, const Red::CClass* aType)
+{
+    if (m_recording)
+    {
+        m_recording->AddRecordExpectation(aRecordId, aType);
+    }
+}
+
+void App::TweakChangeset::StartRecording()
+{
+    m_recording = Core::MakeShared<TweakFragment>();
+}
+
+Core::SharedPtr<App::TweakFragment> App::TweakChangeset::FinishRecording()
+{
+    return std::move(m_recording);
+}
+
 bool App::TweakChangeset::IsEmpty()
 {
     return m_pendingFlats.empty() && m_pendingRecords.empty() && m_pendingMutations.empty() && m_pendingNames.empty();
@@ -194,9 +324,30 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
         aChangelog->ForgetResourcePaths();
     }
 
+    ApplyChanges(aManager, aChangelog);
+}
+
+void App::TweakChangeset::CommitChanges(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                        const Core::SharedPtr<App::TweakChangelog>& aChangelog)
+{
+    if (!aManager || !IsCommitFinished())
+        return;
+
+    StartCommitJob();
+
+    ApplyChanges(aManager, aChangelog);
+}
+
+void App::TweakChangeset::ApplyChanges(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                       const Core::SharedPtr<App::TweakChangelog>& aChangelog)
+{
+    Core::TraceSequence phases("commit");
+
     if (!m_pendingNames.empty())
     {
         StartAsyncCommitJob([&]() {
+            Core::TraceScope trace("commit", "Registering names");
+
             for (const auto& [id, name] : m_pendingNames)
             {
                 aManager->RegisterName(id, name, GetRecordType(id));
@@ -205,6 +356,7 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
     }
 
     LogDebug("Resolving inheritance...");
+    phases.Next("Resolving inheritance");
 
     if (!m_reinheritedProps.empty())
     {
@@ -254,7 +406,8 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
 
                     if (isAssignment)
                     {
-                        auto descendantFlatValue = aManager->GetFlat(descendantFlatId);
+                        // Descendants have the same property, so the type of the source flat is known to match
+                        auto descendantFlatValue = aManager->GetFlat(descendantFlatId, sourceFlatValue.type);
 
                         if (!descendantFlatValue)
                             continue;
@@ -275,7 +428,7 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
                             if (!isConvertedToMutation)
                             {
                                 const auto& sourceAssignment = m_pendingFlats[sourceFlatId];
-                                auto& sourceMutation = m_pendingMutations[sourceFlatId];
+                                auto& sourceMutation = GetMutation(sourceFlatId);
 
                                 sourceMutation.deleteAll = true;
 
@@ -297,14 +450,14 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
                                 isConvertedToMutation = true;
                             }
 
-                            m_pendingMutations[descendantFlatId].baseId = sourceFlatId;
+                            GetMutation(descendantFlatId).baseId = sourceFlatId;
 
                             UpdateRecord(descendantId);
                         }
                     }
                     else if (isMutation)
                     {
-                        auto descendantFlatValue = aManager->GetFlat(descendantFlatId);
+                        auto descendantFlatValue = aManager->GetFlat(descendantFlatId, sourceFlatValue.type);
 
                         if (!descendantFlatValue)
                             continue;
@@ -341,7 +494,7 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
                             }
                         }
 
-                        m_pendingMutations[descendantFlatId].baseId = sourceFlatId;
+                        GetMutation(descendantFlatId).baseId = sourceFlatId;
 
                         UpdateRecord(descendantId);
                     }
@@ -391,44 +544,50 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
                 if (!m_pendingMutations.contains(sourcePropId))
                     continue;
 
-                auto& mutationEntry = m_pendingMutations[targetPropId];
+                auto& mutationEntry = GetMutation(targetPropId);
                 mutationEntry.baseId = sourcePropId;
             }
         }
     }
 
     LogDebug("Resolving mutations...");
+    phases.Next("Resolving mutations");
 
-    for (const auto& [flatId, mutation] : m_pendingMutations)
     {
-        if (!mutation.deleteAll)
-            continue;
-
-        auto flatData = aManager->GetFlat(flatId);
+        Core::Vector<std::pair<Red::TweakDBID, MutationEntry*>> deleteAllMutations;
 
-        if (!flatData.instance || flatData.type->GetType() != Red::ERTTIType::Array)
-            continue;
+        for (auto it = m_pendingMutations.begin(); it != m_pendingMutations.end(); ++it)
+        {
+            if (it->second.deleteAll)
+            {
+                deleteAllMutations.emplace_back(it->first, &it.value());
+            }
+        }
 
-        auto* targetType = reinterpret_cast<const Red::CRTTIArrayType*>(flatData.type);
-        auto* elementType = targetType->innerType;
+        // The arena of the mutations isn't synchronized, so the elements are collected in parallel
+        // and moved to the mutations afterwards
+        Core::Vector<Core::Vector<DeletionEntry>> deletions(deleteAllMutations.size());
+        Core::Vector<uint8_t> resolved(deleteAllMutations.size(), false);
 
-        auto* sourceArray = reinterpret_cast<Red::DynArray<void>*>(flatData.instance);
-        auto sourceLength = targetType->GetLength(sourceArray);
+        Core::ParallelFor(deleteAllMutations.size(), [&](size_t aIndex) {
+            resolved[aIndex] = ResolveDeleteAll(aManager, deleteAllMutations[aIndex].first, deletions[aIndex]);
+        });
 
-        for (uint32_t sourceIndex = 0; sourceIndex < sourceLength; ++sourceIndex)
+        for (size_t i = 0; i < deleteAllMutations.size(); ++i)
         {
-            auto sourceValuePtr = targetType->GetElement(sourceArray, sourceIndex);
-            auto clonedValue = aManager->GetReflection()->Construct(elementType);
-            elementType->Assign(clonedValue.get(), sourceValuePtr);
+            if (!resolved[i])
+                continue;
 
-            const_cast<MutationEntry&>(mutation).deletions.push_back({elementType, std::move(clonedValue)});
+            auto& mutation = *deleteAllMutations[i].second;
+            mutation.deletions.insert(mutation.deletions.end(), std::make_move_iterator(deletions[i].begin()),
+                                      std::make_move_iterator(deletions[i].end()));
+            mutation.deleteAll = false;
         }
-
-        const_cast<MutationEntry&>(mutation).deleteAll = false;
     }
 
     {
         LogDebug("Preparing records...");
+        phases.Next("Preparing records");
 
         const auto batch = aManager->StartBatch();
 
@@ -450,18 +609,30 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
                     aChangelog->RegisterRecord(recordId);
                 }
             }
+            else if (aChangelog)
+            {
+                aChangelog->ReclaimRecord(recordId);
+            }
         }
 
         LogDebug("Committing changes...");
+        phases.Next("Committing records");
 
         aManager->CommitBatch(batch);
     }
 
     {
         LogDebug("Preparing flats...");
+        phases.Next("Preparing flats");
 
         const auto batch = aManager->StartBatch();
 
+        Core::Vector<Red::TweakDBID> flatIds;
+        Core::Vector<Red::Value<>> flatValues;
+
+        flatIds.reserve(m_pendingFlats.size());
+        flatValues.reserve(m_pendingFlats.size());
+
         for (const auto& item : m_pendingFlats)
         {
             const auto& flatId = item.first;
@@ -498,13 +669,13 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
                 }
             }
 
-            const auto success = aManager->SetFlat(batch, flatId, flatType, flatValue);
+            flatIds.push_back(flatId);
+            flatValues.emplace_back(flatType, flatValue);
+        }
 
-            if (!success)
-            {
-                LogError("Can't assign flat {}.", aManager->GetName(flatId));
-                continue;
-            }
+        for (const auto& flatId : aManager->SetFlats(batch, flatIds, flatValues))
+        {
+            LogError("Can't assign flat {}.", aManager->GetName(flatId));
         }
 
         for (const auto& recordId : m_orderedRecords)
@@ -545,230 +716,476 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
         }
 
         LogDebug("Committing changes...");
+        phases.Next("Committing flats");
 
         aManager->CommitBatch(batch);
     }
 
     LogDebug("Applying mutations...");
+    phases.Next("Applying mutations");
 
-    for (const auto& [flatId, mutation] : m_pendingMutations)
     {
-        auto flatData = aManager->GetFlat(flatId);
+        // Mutations only read the current state of TweakDB, so the new values can be resolved
+        // concurrently and then assigned in a fixed order. Mutations that merge other mutated
+        // flats must see the results of those mutations, so they're processed afterwards.
+        Core::Vector<Red::TweakDBID> independentFlats;
+        Core::Vector<Red::TweakDBID> dependentFlats;
 
-        if (!flatData.instance)
+        for (const auto& [flatId, mutation] : m_pendingMutations)
         {
-            auto* elementType = !mutation.prependings.empty()
-                                    ? mutation.prependings.front().type
-                                    : (!mutation.appendings.empty()
-                                           ? mutation.appendings.front().type
-                                           : nullptr);
+            if (IsMergingMutations(mutation))
+            {
+                dependentFlats.push_back(flatId);
+            }
+            else
+            {
+                independentFlats.push_back(flatId);
+            }
+        }
+
+        auto byId = [](Red::TweakDBID aLeft, Red::TweakDBID aRight) {
+            return aLeft.value < aRight.value;
+        };
+
+        std::ranges::sort(independentFlats, byId);
+        std::ranges::sort(dependentFlats, byId);
+
+        Core::Vector<MutationResult> results;
+        results.reserve(independentFlats.size());
 
-            if (!elementType)
+        for (const auto& flatId : independentFlats)
+        {
+            auto& result = results.emplace_back();
+
+            if (!PrepareMutation(aManager, flatId, result))
             {
-                LogError("Cannot modify {}, the flat doesn't exist.", aManager->GetName(flatId));
-                continue;
+                results.pop_back();
             }
+        }
 
-            flatData.type = aManager->GetReflection()->GetArrayType(elementType);
+        Core::ParallelFor(results.size(), [&](size_t aIndex) {
+            auto& result = results[aIndex];
+            ResolveMutation(aManager, m_pendingMutations.find(result.flatId)->second, result);
+        });
+
+        for (const auto& result : results)
+        {
+            ApplyMutation(aManager, aChangelog, result);
         }
-        else if (flatData.type->GetType() != Red::ERTTIType::Array)
+
+        for (const auto& flatId : dependentFlats)
         {
-            LogError("Cannot modify {}, it's not an array.", aManager->GetName(flatId));
-            continue;
+            MutationResult result;
+
+            if (PrepareMutation(aManager, flatId, result))
+            {
+                ResolveMutation(aManager, m_pendingMutations.find(flatId)->second, result);
+                ApplyMutation(aManager, aChangelog, result);
+            }
         }
+    }
 
-#ifndef NDEBUG
-        const auto targetFlatName = aManager->GetReflection()->ToString(flatId);
-#endif
+    LogDebug("Updating records...");
+    phases.Next("Updating records");
+
+    for (const auto& recordId : m_orderedRecords)
+    {
+        const auto success = aManager->UpdateRecord(recordId);
 
-        auto* targetType = reinterpret_cast<const Red::CRTTIArrayType*>(flatData.type);
-        auto* elementType = targetType->innerType;
+        if (!success)
+        {
+            LogError("Cannot update record {}.", aManager->GetName(recordId));
+        }
+    }
 
-        // The data returned by manager is a pointer to the TweakDB flat buffer,
-        // we must make a copy of the original array for modifications.
-        auto targetArray = aManager->GetReflection()->Construct(targetType);
+    phases.End();
 
-        if (flatData.instance)
-            targetType->Assign(targetArray.get(), flatData.instance);
+    FinishCommitJob();
+}
 
-        Core::Vector<ElementChange> skips;
-        Core::Vector<ElementChange> deletions;
-        Core::Vector<ElementChange> insertions;
-        Core::Vector<decltype(&mutation)> chain;
+bool App::TweakChangeset::ResolveDeleteAll(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                           Red::TweakDBID aFlatId, Core::Vector<DeletionEntry>& aDeletions)
+{
+    auto flatData = aManager->GetFlat(aFlatId);
 
+    if (!flatData.instance || flatData.type->GetType() != Red::ERTTIType::Array)
+        return false;
+
+    auto* targetType = reinterpret_cast<const Red::CRTTIArrayType*>(flatData.type);
+    auto* elementType = targetType->innerType;
+
+    auto* sourceArray = reinterpret_cast<Red::DynArray<void>*>(flatData.instance);
+    auto sourceLength = targetType->GetLength(sourceArray);
+
+    for (uint32_t sourceIndex = 0; sourceIndex < sourceLength; ++sourceIndex)
+    {
+        auto sourceValuePtr = targetType->GetElement(sourceArray, sourceIndex);
+        auto clonedValue = aManager->GetReflection()->Construct(elementType);
+        elementType->Assign(clonedValue.get(), sourceValuePtr);
+
+        aDeletions.push_back({elementType, std::move(clonedValue)});
+    }
+
+    return true;
+}
+
+App::TweakChangeset::MutationEntry& App::TweakChangeset::GetMutation(Red::TweakDBID aFlatId)
+{
+    return m_pendingMutations.try_emplace(aFlatId, m_arena).first.value();
+}
+
+bool App::TweakChangeset::IsMergingMutations(const MutationEntry& aMutation)
+{
+    const auto* entry = &aMutation;
+
+    while (true)
+    {
+        for (const auto* merges : {&entry->appendingMerges, &entry->prependingMerges})
         {
-            chain.push_back(&mutation);
+            for (const auto& merge : *merges)
+            {
+                if (m_pendingMutations.contains(merge.sourceId))
+                    return true;
+            }
+        }
 
-            auto baseId = mutation.baseId;
-            while (baseId.IsValid())
+        if (!entry->baseId.IsValid())
+            return false;
+
+        const auto it = m_pendingMutations.find(entry->baseId);
+        if (it == m_pendingMutations.end())
+            return false;
+
+        entry = &it->second;
+    }
+}
+
+bool App::TweakChangeset::PrepareMutation(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                          Red::TweakDBID aFlatId, MutationResult& aResult)
+{
+    const auto& mutation = m_pendingMutations.find(aFlatId)->second;
+    auto flatData = aManager->GetFlat(aFlatId);
+
+    if (!flatData.instance)
+    {
+        auto* elementType = !mutation.prependings.empty()
+                                ? mutation.prependings.front().type
+                                : (!mutation.appendings.empty()
+                                       ? mutation.appendings.front().type
+                                       : nullptr);
+
+        if (!elementType)
+        {
+            LogError("Cannot modify {}, the flat doesn't exist.", aManager->GetName(aFlatId));
+            return false;
+        }
+
+        flatData.type = aManager->GetReflection()->GetArrayType(elementType);
+    }
+    else if (flatData.type->GetType() != Red::ERTTIType::Array)
+    {
+        LogError("Cannot modify {}, it's not an array.", aManager->GetName(aFlatId));
+        return false;
+    }
+
+    aResult.flatId = aFlatId;
+    aResult.type = reinterpret_cast<const Red::CRTTIArrayType*>(flatData.type);
+    aResult.original = flatData.instance;
+
+    return true;
+}
+
+void App::TweakChangeset::ResolveMutation(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                          const MutationEntry& aMutation, MutationResult& aResult)
+{
+    auto* targetType = aResult.type;
+    auto* elementType = targetType->innerType;
+
+    // The data returned by manager is a pointer to the TweakDB flat buffer,
+    // we must make a copy of the original array for modifications.
+    auto targetArray = aManager->GetReflection()->Construct(targetType);
+
+    if (aResult.original)
+        targetType->Assign(targetArray.get(), aResult.original);
+
+    auto& deletions = aResult.deletions;
+    auto& insertions = aResult.insertions;
+    Core::Vector<const MutationEntry*> chain;
+
+    {
+        chain.push_back(&aMutation);
+
+        auto baseId = aMutation.baseId;
+        while (baseId.IsValid())
+        {
+            const auto it = m_pendingMutations.find(baseId);
+            if (it == m_pendingMutations.end())
+                break;
+
+            chain.push_back(&it->second);
+            baseId = it->second.baseId;
+        }
+
+        std::reverse(chain.begin(), chain.end());
+    }
+
+    // Values deleted on each level of the chain, an insertion is skipped
+    // if the same value is deleted by any of the descendant levels.
+    Core::Vector<ElementIndex> skips;
+    skips.reserve(chain.size());
+
+    {
+        const auto originalLength = static_cast<int32_t>(targetType->GetLength(targetArray.get()));
+        auto hasDeletions = false;
+
+        for (const auto& entry : chain)
+        {
+            auto& levelSkips = skips.emplace_back(elementType);
+
+            for (const auto& deletion : entry->deletions)
             {
-                auto& entry = m_pendingMutations[baseId];
-                chain.push_back(&entry);
-#ifndef NDEBUG
-                const auto baseFlatName = aManager->GetReflection()->ToString(baseId);
-#endif
-                baseId = entry.baseId;
+                levelSkips.Add(deletion.value.get());
             }
 
-            std::reverse(chain.begin(), chain.end());
+            hasDeletions = hasDeletions || !entry->deletions.empty();
         }
 
+        if (hasDeletions)
         {
-            auto chainLevel = 0;
+            ElementIndex originalIndex(elementType);
+            for (int32_t i = 0; i < originalLength; ++i)
+            {
+                originalIndex.Add(targetType->GetElement(targetArray.get(), i), i);
+            }
+
+            Core::Vector<bool> deleted(originalLength, false);
 
             for (const auto& entry : chain)
             {
                 for (const auto& deletion : entry->deletions)
                 {
-                    const auto deletionValue = deletion.value;
-                    const auto deletionIndex = FindElement(targetType, targetArray.get(), deletionValue.get());
+                    const auto deletionIndex = originalIndex.Find(deletion.value.get());
 
-                    if (deletionIndex >= 0)
+                    if (deletionIndex >= 0 && !deleted[deletionIndex])
                     {
-                        deletions.emplace_back(deletionIndex, deletionValue);
+                        deleted[deletionIndex] = true;
+                        deletions.emplace_back(deletionIndex, deletion.value);
                     }
-
-                    skips.emplace_back(chainLevel, deletionValue);
                 }
-
-                ++chainLevel;
             }
 
             if (!deletions.empty())
             {
-                auto descending = [](ElementChange& a, ElementChange& b) { return a.first > b.first; };
-                std::sort(deletions.begin(), deletions.end(), descending);
+                // Remove all deleted elements in a single pass by shifting the remaining ones
+                // to the front and dropping the tail.
+                int32_t writeIndex = 0;
+                for (int32_t readIndex = 0; readIndex < originalLength; ++readIndex)
+                {
+                    if (deleted[readIndex])
+                        continue;
+
+                    if (writeIndex != readIndex)
+                    {
+                        elementType->Assign(targetType->GetElement(targetArray.get(), writeIndex),
+                                            targetType->GetElement(targetArray.get(), readIndex));
+                    }
 
-                for (const auto& [deletionIndex, deletionEntry] : deletions)
+                    ++writeIndex;
+                }
+
+                for (auto lastIndex = originalLength - 1; lastIndex >= writeIndex; --lastIndex)
                 {
-                    targetType->RemoveAt(targetArray.get(), deletionIndex);
+                    targetType->RemoveAt(targetArray.get(), lastIndex);
                 }
+
+                std::sort(deletions.begin(), deletions.end(), [](ElementChange& a, ElementChange& b) {
+                    return a.first > b.first;
+                });
             }
         }
+    }
 
-        {
-            auto chainLevel = 0;
-            auto insertionIndex = 0;
+    {
+        // The target array isn't modified until all insertions are collected,
+        // so the index can point directly to its elements.
+        const auto remainingLength = static_cast<int32_t>(targetType->GetLength(targetArray.get()));
 
-            auto performInsertions = [&, flatId = flatId](const Core::Vector<InsertionEntry>& aInsertions,
-                                                          const Core::Vector<MergingEntry>& aMerges)
+        ElementIndex presentElements(elementType);
+        auto isIndexed = false;
+
+        auto isPresent = [&](void* aValue) {
+            if (!isIndexed)
             {
-                for (const auto& insertion : aInsertions)
+                for (int32_t i = 0; i < remainingLength; ++i)
                 {
-                    const auto& insertionValue = insertion.value;
+                    presentElements.Add(targetType->GetElement(targetArray.get(), i));
+                }
 
-                    if (insertion.unique && InArray(targetType, targetArray.get(), insertionValue.get()))
-                        continue;
+                for (const auto& insertion : insertions)
+                {
+                    presentElements.Add(insertion.second.get());
+                }
 
-                    if (IsSkip(targetType, insertionValue.get(), chainLevel, skips))
-                        continue;
+                isIndexed = true;
+            }
 
-                    targetType->InsertAt(targetArray.get(), insertionIndex);
-                    elementType->Assign(targetType->GetElement(targetArray.get(), insertionIndex), insertionValue.get());
+            return presentElements.Find(aValue) >= 0;
+        };
 
-                    insertions.emplace_back(insertionIndex, insertionValue);
+        auto isSkipped = [&](void* aValue, size_t aLevel) {
+            for (auto level = aLevel + 1; level < skips.size(); ++level)
+            {
+                if (skips[level].Find(aValue) >= 0)
+                    return true;
+            }
 
-                    ++insertionIndex;
-                }
+            return false;
+        };
 
-                for (const auto& merge : aMerges)
-                {
-                    const auto sourceData = aManager->GetFlat(merge.sourceId);
+        auto addInsertion = [&](const Core::SharedPtr<void>& aValue) {
+            insertions.emplace_back(0, aValue);
 
-                    if (!sourceData.instance || sourceData.type != targetType)
-                    {
-                        LogError("Cannot merge {} with {} because it's not an array.",
-                                 aManager->GetName(merge.sourceId), aManager->GetName(flatId));
-                        continue;
-                    }
+            if (isIndexed)
+            {
+                presentElements.Add(aValue.get());
+            }
+        };
 
-                    auto* sourceArray = reinterpret_cast<Red::DynArray<void>*>(sourceData.instance);
-                    const auto sourceLength = targetType->GetLength(sourceArray);
+        auto performInsertions = [&](const Core::Vector<InsertionEntry>& aInsertions,
+                                     const Core::Vector<MergingEntry>& aMerges, size_t aLevel)
+        {
+            for (const auto& insertion : aInsertions)
+            {
+                const auto& insertionValue = insertion.value;
 
-                    for (uint32_t sourceIndex = 0; sourceIndex < sourceLength; ++sourceIndex)
-                    {
-                        const auto insertionValuePtr = targetType->GetElement(sourceArray, sourceIndex);
+                if (insertion.unique && isPresent(insertionValue.get()))
+                    continue;
 
-                        if (InArray(targetType, targetArray.get(), insertionValuePtr))
-                            continue;
+                if (isSkipped(insertionValue.get(), aLevel))
+                    continue;
 
-                        if (IsSkip(targetType, insertionValuePtr, chainLevel, skips))
-                            continue;
+                addInsertion(insertionValue);
+            }
 
-                        targetType->InsertAt(targetArray.get(), insertionIndex);
-                        elementType->Assign(targetType->GetElement(targetArray.get(), insertionIndex), insertionValuePtr);
+            for (const auto& merge : aMerges)
+            {
+                const auto sourceData = aManager->GetFlat(merge.sourceId);
 
-                        auto clonedValue = aManager->GetReflection()->Construct(elementType);
-                        elementType->Assign(clonedValue.get(), insertionValuePtr);
+                if (!sourceData.instance || sourceData.type != targetType)
+                {
+                    aResult.failedMerges.push_back(merge.sourceId);
+                    continue;
+                }
 
-                        insertions.emplace_back(insertionIndex, clonedValue);
+                auto* sourceArray = reinterpret_cast<Red::DynArray<void>*>(sourceData.instance);
+                const auto sourceLength = targetType->GetLength(sourceArray);
 
-                        ++insertionIndex;
-                    }
-                }
-            };
+                for (uint32_t sourceIndex = 0; sourceIndex < sourceLength; ++sourceIndex)
+                {
+                    const auto insertionValuePtr = targetType->GetElement(sourceArray, sourceIndex);
 
-            chainLevel = 0;
+                    if (isPresent(insertionValuePtr))
+                        continue;
 
-            for (const auto& entry : chain)
-            {
-                performInsertions(entry->prependings, entry->prependingMerges);
-                ++chainLevel;
-            }
+                    if (isSkipped(insertionValuePtr, aLevel))
+                        continue;
 
-            chainLevel = 0;
-            insertionIndex = static_cast<int32_t>(targetType->GetLength(targetArray.get()));
+                    auto clonedValue = aManager->GetReflection()->Construct(elementType);
+                    elementType->Assign(clonedValue.get(), insertionValuePtr);
 
-            for (const auto& entry : chain)
-            {
-                performInsertions(entry->appendings, entry->appendingMerges);
-                ++chainLevel;
+                    addInsertion(clonedValue);
+                }
             }
+        };
+
+        for (size_t level = 0; level < chain.size(); ++level)
+        {
+            performInsertions(chain[level]->prependings, chain[level]->prependingMerges, level);
         }
 
-        const auto success = aManager->SetFlat(flatId, targetType, targetArray.get());
+        const auto prependCount = static_cast<int32_t>(insertions.size());
 
-        if (!success)
+        for (size_t level = 0; level < chain.size(); ++level)
         {
-            LogError("Cannot assign flat value {}.", aManager->GetName(flatId));
-            continue;
+            performInsertions(chain[level]->appendings, chain[level]->appendingMerges, level);
         }
 
-        if (aChangelog)
+        if (!insertions.empty())
         {
-            const auto isForeignKey = aManager->GetReflection()->IsForeignKeyArray(targetType);
+            // Build the final array at once: prepended elements, remaining elements, appended elements.
+            auto resultArray = aManager->GetReflection()->Construct(targetType);
+            int32_t resultIndex = 0;
+
+            auto pushElement = [&](void* aValue) {
+                targetType->InsertAt(resultArray.get(), resultIndex);
+                elementType->Assign(targetType->GetElement(resultArray.get(), resultIndex), aValue);
+                ++resultIndex;
+            };
 
-            for (const auto& [deletionIndex, deletionValue] : deletions)
+            for (int32_t i = 0; i < prependCount; ++i)
             {
-                aChangelog->RegisterDeletion(flatId, deletionIndex, deletionValue);
+                insertions[i].first = resultIndex;
+                pushElement(insertions[i].second.get());
             }
 
-            for (const auto& [insertionIndex, insertionValue] : insertions)
+            for (int32_t i = 0; i < remainingLength; ++i)
             {
-                aChangelog->RegisterInsertion(flatId, insertionIndex, insertionValue);
+                pushElement(targetType->GetElement(targetArray.get(), i));
+            }
 
-                if (isForeignKey)
-                {
-                    const auto foreignKey = reinterpret_cast<Red::TweakDBID*>(insertionValue.get());
-                    aChangelog->RegisterForeignKey(*foreignKey, flatId);
-                }
+            for (auto i = static_cast<size_t>(prependCount); i < insertions.size(); ++i)
+            {
+                insertions[i].first = resultIndex;
+                pushElement(insertions[i].second.get());
             }
+
+            targetArray = std::move(resultArray);
         }
     }
 
-    LogDebug("Updating records...");
+    aResult.value = std::move(targetArray);
+}
 
-    for (const auto& recordId : m_orderedRecords)
+void App::TweakChangeset::ApplyMutation(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                        const Core::SharedPtr<App::TweakChangelog>& aChangelog,
+                                        const MutationResult& aResult)
+{
+    const auto& flatId = aResult.flatId;
+
+    for (const auto& sourceId : aResult.failedMerges)
     {
-        const auto success = aManager->UpdateRecord(recordId);
+        LogError("Cannot merge {} with {} because it's not an array.",
+                 aManager->GetName(sourceId), aManager->GetName(flatId));
+    }
 
-        if (!success)
+    const auto success = aManager->SetFlat(flatId, aResult.type, aResult.value.get());
+
+    if (!success)
+    {
+        LogError("Cannot assign flat value {}.", aManager->GetName(flatId));
+        return;
+    }
+
+    if (aChangelog)
+    {
+        const auto isForeignKey = aManager->GetReflection()->IsForeignKeyArray(aResult.type);
+
+        for (const auto& [deletionIndex, deletionValue] : aResult.deletions)
         {
-            LogError("Cannot update record {}.", aManager->GetName(recordId));
+            aChangelog->RegisterDeletion(flatId, deletionIndex, deletionValue);
         }
-    }
 
-    FinishCommitJob();
+        for (const auto& [insertionIndex, insertionValue] : aResult.insertions)
+        {
+            aChangelog->RegisterInsertion(flatId, insertionIndex, insertionValue);
+
+            if (isForeignKey)
+            {
+                const auto foreignKey = reinterpret_cast<Red::TweakDBID*>(insertionValue.get());
+                aChangelog->RegisterForeignKey(*foreignKey, flatId);
+            }
+        }
+    }
 }
 
 bool App::TweakChangeset::IsCommitFinished()
@@ -802,44 +1219,11 @@ void App::TweakChangeset::FinishCommitJob()
             m_pendingNames.clear();
             m_pendingMutations.clear();
 
+            // Nothing refers to the arena once the mutations are gone, so all of its blocks are released at once
+            m_arena = Core::MakeShared<Core::MonotonicArena>(ArenaBlockSize);
+
             m_totalCommitChunks = 0;
             m_finishedCommitChunks = 0;
         }
     }
 }
-
-int32_t App::TweakChangeset::FindElement(const Red::CRTTIArrayType* aArrayType, void* aArray, void* aValue)
-{
-    const auto length = aArrayType->GetLength(aArray);
-
-    for (int32_t i = 0; i < length; ++i)
-    {
-        const auto element = aArrayType->GetElement(aArray, i);
-
-        if (aArrayType->innerType->IsEqual(element, aValue))
-        {
-            return i;
-        }
-    }
-
-    return -1;
-}
-
-bool App::TweakChangeset::InArray(const Red::CRTTIArrayType* aArrayType, void* aArray, void* aValue)
-{
-    return FindElement(aArrayType, aArray, aValue) >= 0;
-}
-
-bool App::TweakChangeset::IsSkip(const Red::CRTTIArrayType* aArrayType, void* aValue, int32_t aLevel,
-                                 const Core::Vector<ElementChange>& aChanges)
-{
-    for (const auto& [level, value] : aChanges)
-    {
-        if (level > aLevel && aArrayType->innerType->IsEqual(value.get(), aValue))
-        {
-            return true;
-        }
-    }
-
-    return false;
-}
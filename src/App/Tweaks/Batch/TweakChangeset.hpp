@@ -1,7 +1,9 @@
 #pragma once
 
 #include "App/Tweaks/Batch/TweakChangelog.hpp"
+#include "App/Tweaks/Batch/TweakFragment.hpp"
 #include "Core/Logging/LoggingAgent.hpp"
+#include "Core/Memory/MonotonicArena.hpp"
 #include "Red/TweakDB/Manager.hpp"
 
 namespace App
@@ -41,13 +43,30 @@ public:
         Red::TweakDBID sourceId;
     };
 
+    template<typename T>
+    using ArenaVector = std::vector<T, Core::ArenaAllocator<T>>;
+
+    // Mutations only live until the commit, so their lists are allocated from the arena of the changeset,
+    // which is released when the commit finishes. The values themselves stay on the heap: they are constructed
+    // by the readers before the changeset exists and outlive the commit in fragments and the changelog.
     struct MutationEntry
     {
-        Core::Vector<DeletionEntry> deletions;
-        Core::Vector<InsertionEntry> appendings;
-        Core::Vector<InsertionEntry> prependings;
-        Core::Vector<MergingEntry> appendingMerges;
-        Core::Vector<MergingEntry> prependingMerges;
+        explicit MutationEntry(const Core::SharedPtr<Core::MonotonicArena>& aArena)
+            : deletions(Core::ArenaAllocator<DeletionEntry>(aArena))
+            , appendings(Core::ArenaAllocator<InsertionEntry>(aArena))
+            , prependings(Core::ArenaAllocator<InsertionEntry>(aArena))
+            , appendingMerges(Core::ArenaAllocator<MergingEntry>(aArena))
+            , prependingMerges(Core::ArenaAllocator<MergingEntry>(aArena))
+            , baseId()
+            , deleteAll(false)
+        {
+        }
+
+        ArenaVector<DeletionEntry> deletions;
+        ArenaVector<InsertionEntry> appendings;
+        ArenaVector<InsertionEntry> prependings;
+        ArenaVector<MergingEntry> appendingMerges;
+        ArenaVector<MergingEntry> prependingMerges;
         Red::TweakDBID baseId;
         bool deleteAll;
     };
@@ -81,14 +100,49 @@ public:
     const Red::CClass* GetRecordType(Red::TweakDBID aRecordId);
     bool HasRecord(Red::TweakDBID aRecordId);
 
+    void TrackFlatLookup(Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType);
+    void TrackRecordLookup(Red::TweakDBID aRecordId, const Red::CClass* aType);
+
+    void StartRecording();
+    Core::SharedPtr<TweakFragment> FinishRecording();
+
     bool IsEmpty();
 
     void Commit(const Core::SharedPtr<Red::TweakDBManager>& aManager,
                 const Core::SharedPtr<App::TweakChangelog>& aChangelog);
 
+    // Commits the pending changes on top of the current state without reverting the changelog first.
+    void CommitChanges(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                       const Core::SharedPtr<App::TweakChangelog>& aChangelog);
+
 private:
     using ElementChange = std::pair<int32_t, Core::SharedPtr<void>>;
 
+    struct MutationResult
+    {
+        Red::TweakDBID flatId;
+        const Red::CRTTIArrayType* type;
+        Red::Instance original;
+        Red::InstancePtr<> value;
+        Core::Vector<ElementChange> deletions;
+        Core::Vector<ElementChange> insertions;
+        Core::Vector<Red::TweakDBID> failedMerges;
+    };
+
+    void ApplyChanges(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                      const Core::SharedPtr<App::TweakChangelog>& aChangelog);
+
+    MutationEntry& GetMutation(Red::TweakDBID aFlatId);
+    bool ResolveDeleteAll(const Core::SharedPtr<Red::TweakDBManager>& aManager, Red::TweakDBID aFlatId,
+                          Core::Vector<DeletionEntry>& aDeletions);
+    bool IsMergingMutations(const MutationEntry& aMutation);
+    bool PrepareMutation(const Core::SharedPtr<Red::TweakDBManager>& aManager, Red::TweakDBID aFlatId,
+                         MutationResult& aResult);
+    void ResolveMutation(const Core::SharedPtr<Red::TweakDBManager>& aManager, const MutationEntry& aMutation,
+                         MutationResult& aResult);
+    void ApplyMutation(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                       const Core::SharedPtr<App::TweakChangelog>& aChangelog, const MutationResult& aResult);
+
     bool IsCommitFinished();
     void StartCommitJob();
     void FinishCommitJob();
@@ -102,18 +156,17 @@ private:
         jobQueue.Dispatch([self = ToShared()]{ self->FinishCommitJob(); });
     }
 
-    static int32_t FindElement(const Red::CRTTIArrayType* aArrayType, void* aArray, void* aValue);
-    static bool InArray(const Red::CRTTIArrayType* aArrayType, void* aArray, void* aValue);
-    static bool IsSkip(const Red::CRTTIArrayType* aArrayType, void* aValue, int32_t aLevel,
-                       const Core::Vector<ElementChange>& aChanges);
+    static constexpr size_t ArenaBlockSize = 64 * 1024;
 
     Core::WeakPtr<TweakChangeset> m_self;
+    Core::SharedPtr<Core::MonotonicArena> m_arena{Core::MakeShared<Core::MonotonicArena>(ArenaBlockSize)};
     Core::Vector<Red::TweakDBID> m_orderedRecords;
     Core::Map<Red::TweakDBID, RecordEntry> m_pendingRecords;
     Core::Map<Red::TweakDBID, MutationEntry> m_pendingMutations;
     Core::Map<Red::TweakDBID, FlatEntry> m_pendingFlats;
     Core::Map<Red::TweakDBID, ReinheritanceEntry> m_reinheritedProps;
     Core::Map<Red::TweakDBID, std::string> m_pendingNames;
+    Core::SharedPtr<TweakFragment> m_recording;
 
     std::mutex m_commitMutex;
     int32_t m_totalCommitChunks{0};
@@ -0,0 +1,473 @@
+#include "TweakFragment.hpp"
+#include "App/Tweaks/Batch/TweakChangeset.hpp"
+
+void App::TweakFragment::AddOperation(Operation&& aOperation)
+{
+    switch (aOperation.type)
+    {
+    case OperationType::SetFlat:
+        m_lastFlatExpectations.erase(aOperation.id);
+        break;
+    case OperationType::MakeRecord:
+        m_lastRecordExpectations.erase(aOperation.id);
+        break;
+    default:
+        break;
+    }
+
+    m_operations.emplace_back(std::move(aOperation));
+}
+
+void App::TweakFragment::AddFlatExpectation(Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType)
+{
+    const auto it = m_lastFlatExpectations.find(aFlatId);
+    if (it != m_lastFlatExpectations.end() && it->second == aType)
+        return;
+
+    m_lastFlatExpectations[aFlatId] = aType;
+    m_operations.push_back({OperationType::ExpectFlat, aFlatId, {}, aType});
+}
+
+void App::TweakFragment::AddRecordExpectation(Red::TweakDBID aRecordId, const Red::CClass* aType)
+{
+    const auto it = m_lastRecordExpectations.find(aRecordId);
+    if (it != m_lastRecordExpectations.end() && it->second == aType)
+        return;
+
+    m_lastRecordExpectations[aRecordId] = aType;
+    m_operations.push_back({OperationType::ExpectRecord, aRecordId, {}, aType});
+}
+
+bool App::TweakFragment::IsApplicable(TweakChangeset& aChangeset,
+                                      const Core::SharedPtr<Red::TweakDBManager>& aManager) const
+{
+    // Simulate the effect of the recorded operations on type resolution
+    // without touching the changeset, and compare every lookup result
+    // with the one observed when the fragment was recorded.
+    Core::Map<Red::TweakDBID, const Red::CBaseRTTIType*> pendingFlats;
+    Core::Map<Red::TweakDBID, const Red::CClass*> pendingRecords;
+
+    auto resolveRecordType = [&](Red::TweakDBID aRecordId) -> const Red::CClass* {
+        const auto it = pendingRecords.find(aRecordId);
+        if (it != pendingRecords.end())
+            return it->second;
+
+        return aChangeset.GetRecordType(aRecordId);
+    };
+
+    for (const auto& operation : m_operations)
+    {
+        switch (operation.type)
+        {
+        case OperationType::SetFlat:
+        {
+            pendingFlats[operation.id] = operation.valueType;
+            break;
+        }
+        case OperationType::MakeRecord:
+        {
+            if (!resolveRecordType(operation.id))
+            {
+                pendingRecords[operation.id] = reinterpret_cast<const Red::CClass*>(operation.valueType);
+            }
+            break;
+        }
+        case OperationType::ExpectFlat:
+        {
+            const Red::CBaseRTTIType* resolvedType = nullptr;
+
+            const auto existingFlat = aManager->GetFlat(operation.id);
+            if (existingFlat.instance)
+            {
+                resolvedType = existingFlat.type;
+            }
+            else if (const auto it = pendingFlats.find(operation.id); it != pendingFlats.end())
+            {
+                resolvedType = it->second;
+            }
+            else if (const auto pendingFlat = aChangeset.GetFlat(operation.id))
+            {
+                resolvedType = pendingFlat->type;
+            }
+
+            if (resolvedType != operation.valueType)
+                return false;
+
+            break;
+        }
+        case OperationType::ExpectRecord:
+        {
+            const Red::CClass* resolvedType = aManager->GetRecordType(operation.id);
+
+            if (!resolvedType)
+            {
+                resolvedType = resolveRecordType(operation.id);
+            }
+
+            if (resolvedType != operation.valueType)
+                return false;
+
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    return true;
+}
+
+void App::TweakFragment::Apply(TweakChangeset& aChangeset) const
+{
+    for (const auto& operation : m_operations)
+    {
+        switch (operation.type)
+        {
+        case OperationType::SetFlat:
+            aChangeset.SetFlat(operation.id, operation.valueType, operation.value);
+            break;
+        case OperationType::ReinheritFlat:
+            aChangeset.ReinheritFlat(operation.id, operation.sourceId, operation.name);
+            break;
+        case OperationType::MakeRecord:
+            aChangeset.MakeRecord(operation.id, reinterpret_cast<const Red::CClass*>(operation.valueType),
+                                  operation.sourceId);
+            break;
+        case OperationType::UpdateRecord:
+            aChangeset.UpdateRecord(operation.id);
+            break;
+        case OperationType::AppendElement:
+            aChangeset.AppendElement(operation.id, operation.valueType, operation.value, operation.unique);
+            break;
+        case OperationType::PrependElement:
+            aChangeset.PrependElement(operation.id, operation.valueType, operation.value, operation.unique);
+            break;
+        case OperationType::RemoveElement:
+            aChangeset.RemoveElement(operation.id, operation.valueType, operation.value);
+            break;
+        case OperationType::RemoveAllElements:
+            aChangeset.RemoveAllElements(operation.id);
+            break;
+        case OperationType::AppendFrom:
+            aChangeset.AppendFrom(operation.id, operation.sourceId);
+            break;
+        case OperationType::PrependFrom:
+            aChangeset.PrependFrom(operation.id, operation.sourceId);
+            break;
+        case OperationType::RegisterName:
+            aChangeset.RegisterName(operation.id, operation.name);
+            break;
+        case OperationType::ExpectFlat:
+            aChangeset.TrackFlatLookup(operation.id, operation.valueType);
+            break;
+        case OperationType::ExpectRecord:
+            aChangeset.TrackRecordLookup(operation.id, reinterpret_cast<const Red::CClass*>(operation.valueType));
+            break;
+        }
+    }
+}
+
+void App::TweakFragment::CollectFootprint(Footprint& aFootprint,
+                                          const Core::SharedPtr<Red::TweakDBManager>& aManager) const
+{
+    auto reflection = aManager->GetReflection();
+
+    for (const auto& operation : m_operations)
+    {
+        switch (operation.type)
+        {
+        case OperationType::SetFlat:
+        case OperationType::AppendElement:
+        case OperationType::PrependElement:
+        case OperationType::RemoveElement:
+        case OperationType::RemoveAllElements:
+        {
+            aFootprint.flats.insert(operation.id);
+            break;
+        }
+        case OperationType::AppendFrom:
+        case OperationType::PrependFrom:
+        {
+            aFootprint.flats.insert(operation.id);
+            aFootprint.sourceFlats.insert(operation.sourceId);
+            break;
+        }
+        case OperationType::ReinheritFlat:
+        {
+            // The value of the flat is propagated to the descendants on commit
+            for (const auto& descendantId : reflection->GetOriginalDescendants(operation.sourceId))
+            {
+                aFootprint.flats.insert(Red::TweakDBID(descendantId, operation.name));
+                aFootprint.records.insert(descendantId);
+            }
+            break;
+        }
+        case OperationType::MakeRecord:
+        {
+            // New records get all props on commit, not only the ones set by the source
+            const auto recordInfo = reflection->GetRecordInfo(reinterpret_cast<const Red::CClass*>(operation.valueType));
+            if (recordInfo)
+            {
+                for (const auto& [_, propInfo] : recordInfo->props)
+                {
+                    aFootprint.flats.insert(operation.id + propInfo->appendix);
+                }
+            }
+
+            aFootprint.records.insert(operation.id);
+
+            if (operation.sourceId.IsValid())
+            {
+                aFootprint.sourceRecords.insert(operation.sourceId);
+            }
+            break;
+        }
+        case OperationType::UpdateRecord:
+        {
+            aFootprint.records.insert(operation.id);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+void App::TweakFragment::Serialize(Core::BinaryWriter& aWriter) const
+{
+    aWriter.Write(static_cast<uint32_t>(m_operations.size()));
+
+    for (const auto& operation : m_operations)
+    {
+        aWriter.Write(operation.type);
+        aWriter.Write(operation.id.value);
+
+        switch (operation.type)
+        {
+        case OperationType::SetFlat:
+        case OperationType::RemoveElement:
+        case OperationType::AppendElement:
+        case OperationType::PrependElement:
+        {
+            aWriter.Write(static_cast<uint64_t>(operation.valueType->GetName()));
+            WriteValue(aWriter, operation.valueType, operation.value.get());
+
+            if (operation.type == OperationType::AppendElement || operation.type == OperationType::PrependElement)
+            {
+                aWriter.Write(operation.unique);
+            }
+            break;
+        }
+        case OperationType::ReinheritFlat:
+        {
+            aWriter.Write(operation.sourceId.value);
+            aWriter.WriteString(operation.name);
+            break;
+        }
+        case OperationType::MakeRecord:
+        {
+            aWriter.Write(static_cast<uint64_t>(operation.valueType->GetName()));
+            aWriter.Write(operation.sourceId.value);
+            break;
+        }
+        case OperationType::AppendFrom:
+        case OperationType::PrependFrom:
+        {
+            aWriter.Write(operation.sourceId.value);
+            break;
+        }
+        case OperationType::RegisterName:
+        {
+            aWriter.WriteString(operation.name);
+            break;
+        }
+        case OperationType::ExpectFlat:
+        case OperationType::ExpectRecord:
+        {
+            aWriter.Write(operation.valueType ? static_cast<uint64_t>(operation.valueType->GetName()) : 0ull);
+            break;
+        }
+        case OperationType::UpdateRecord:
+        case OperationType::RemoveAllElements:
+            break;
+        }
+    }
+}
+
+Core::SharedPtr<App::TweakFragment> App::TweakFragment::Deserialize(
+    Core::BinaryReader& aReader, const Core::SharedPtr<Red::TweakDBManager>& aManager)
+{
+    auto reflection = aManager->GetReflection();
+    auto fragment = Core::MakeShared<TweakFragment>();
+
+    const auto operationCount = aReader.Read<uint32_t>();
+    fragment->m_operations.reserve(operationCount);
+
+    for (uint32_t i = 0; i < operationCount && !aReader.IsFailed(); ++i)
+    {
+        Operation operation{};
+        operation.type = aReader.Read<OperationType>();
+        operation.id = aReader.Read<uint64_t>();
+
+        switch (operation.type)
+        {
+        case OperationType::SetFlat:
+        case OperationType::RemoveElement:
+        case OperationType::AppendElement:
+        case OperationType::PrependElement:
+        {
+            operation.valueType = reflection->GetFlatType(aReader.Read<uint64_t>());
+            if (!operation.valueType)
+                return nullptr;
+
+            operation.value = reflection->Construct(operation.valueType);
+            if (!ReadValue(aReader, operation.valueType, operation.value.get()))
+                return nullptr;
+
+            if (operation.type == OperationType::AppendElement || operation.type == OperationType::PrependElement)
+            {
+                operation.unique = aReader.Read<bool>();
+            }
+            break;
+        }
+        case OperationType::ReinheritFlat:
+        {
+            operation.sourceId = aReader.Read<uint64_t>();
+            operation.name = aReader.ReadString();
+            break;
+        }
+        case OperationType::MakeRecord:
+        {
+            operation.valueType = reflection->GetRecordType(aReader.Read<uint64_t>());
+            operation.sourceId = aReader.Read<uint64_t>();
+
+            if (!operation.valueType)
+                return nullptr;
+            break;
+        }
+        case OperationType::AppendFrom:
+        case OperationType::PrependFrom:
+        {
+            operation.sourceId = aReader.Read<uint64_t>();
+            break;
+        }
+        case OperationType::RegisterName:
+        {
+            operation.name = aReader.ReadString();
+            break;
+        }
+        case OperationType::ExpectFlat:
+        case OperationType::ExpectRecord:
+        {
+            const Red::CName typeName = aReader.Read<uint64_t>();
+
+            if (typeName)
+            {
+                operation.valueType = operation.type == OperationType::ExpectFlat
+                                          ? reflection->GetFlatType(typeName)
+                                          : reflection->GetRecordType(typeName);
+
+                if (!operation.valueType)
+                    return nullptr;
+            }
+            break;
+        }
+        case OperationType::UpdateRecord:
+        case OperationType::RemoveAllElements:
+            break;
+        default:
+            return nullptr;
+        }
+
+        fragment->m_operations.emplace_back(std::move(operation));
+    }
+
+    if (aReader.IsFailed())
+        return nullptr;
+
+    return fragment;
+}
+
+void App::TweakFragment::WriteValue(Core::BinaryWriter& aWriter, const Red::CBaseRTTIType* aType, const void* aValue)
+{
+    if (aType->GetType() == Red::ERTTIType::Array)
+    {
+        auto* arrayType = reinterpret_cast<const Red::CRTTIArrayType*>(aType);
+        auto* elementType = arrayType->innerType;
+        auto* array = const_cast<void*>(aValue);
+        const auto length = arrayType->GetLength(array);
+
+        aWriter.Write(length);
+
+        for (uint32_t i = 0; i < length; ++i)
+        {
+            WriteValue(aWriter, elementType, arrayType->GetElement(array, i));
+        }
+        return;
+    }
+
+    switch (aType->GetName())
+    {
+    case Red::ERTDBFlatType::String:
+    {
+        aWriter.WriteString(reinterpret_cast<const Red::CString*>(aValue)->c_str());
+        break;
+    }
+    case Red::ERTDBFlatType::CName:
+    {
+        const auto* name = reinterpret_cast<const Red::CName*>(aValue);
+        aWriter.WriteString(*name ? name->ToString() : "");
+        break;
+    }
+    default:
+    {
+        aWriter.WriteBytes(aValue, aType->GetSize());
+        break;
+    }
+    }
+}
+
+bool App::TweakFragment::ReadValue(Core::BinaryReader& aReader, const Red::CBaseRTTIType* aType, void* aValue)
+{
+    if (aType->GetType() == Red::ERTTIType::Array)
+    {
+        auto* arrayType = reinterpret_cast<const Red::CRTTIArrayType*>(aType);
+        auto* elementType = arrayType->innerType;
+        const auto length = aReader.Read<uint32_t>();
+
+        for (uint32_t i = 0; i < length; ++i)
+        {
+            arrayType->InsertAt(aValue, i);
+
+            if (!ReadValue(aReader, elementType, arrayType->GetElement(aValue, i)))
+                return false;
+        }
+
+        return !aReader.IsFailed();
+    }
+
+    switch (aType->GetName())
+    {
+    case Red::ERTDBFlatType::String:
+    {
+        *reinterpret_cast<Red::CString*>(aValue) = aReader.ReadString().c_str();
+        break;
+    }
+    case Red::ERTDBFlatType::CName:
+    {
+        const auto str = aReader.ReadString();
+        if (!str.empty())
+        {
+            *reinterpret_cast<Red::CName*>(aValue) = Red::CNamePool::Add(str.c_str());
+        }
+        break;
+    }
+    default:
+    {
+        aReader.ReadBytes(aValue, aType->GetSize());
+        break;
+    }
+    }
+
+    return !aReader.IsFailed();
+}
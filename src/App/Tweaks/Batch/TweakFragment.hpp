@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Core/Memory/Binary.hpp"
+#include "Red/TweakDB/Manager.hpp"
+
+namespace App
+{
+class TweakChangeset;
+
+// A recorded sequence of changeset operations produced by reading a single source.
+// Besides the operations, it keeps the results of every flat and record lookup made
+// while reading, so that it can be checked whether the fragment is still applicable
+// to a changeset in a different state without reading the source again.
+class TweakFragment
+{
+public:
+    enum class OperationType : uint8_t
+    {
+        SetFlat,
+        ReinheritFlat,
+        MakeRecord,
+        UpdateRecord,
+        AppendElement,
+        PrependElement,
+        RemoveElement,
+        RemoveAllElements,
+        AppendFrom,
+        PrependFrom,
+        RegisterName,
+        ExpectFlat,
+        ExpectRecord,
+    };
+
+    struct Operation
+    {
+        OperationType type;
+        Red::TweakDBID id;
+        Red::TweakDBID sourceId;
+        const Red::CBaseRTTIType* valueType;
+        Red::InstancePtr<> value;
+        std::string name;
+        bool unique;
+    };
+
+    // The sets of flats and records the fragment changes or depends on.
+    struct Footprint
+    {
+        Core::Set<Red::TweakDBID> flats;
+        Core::Set<Red::TweakDBID> records;
+        Core::Set<Red::TweakDBID> sourceFlats;
+        Core::Set<Red::TweakDBID> sourceRecords;
+    };
+
+    void AddOperation(Operation&& aOperation);
+    void AddFlatExpectation(Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType);
+    void AddRecordExpectation(Red::TweakDBID aRecordId, const Red::CClass* aType);
+
+    bool IsApplicable(TweakChangeset& aChangeset, const Core::SharedPtr<Red::TweakDBManager>& aManager) const;
+    void Apply(TweakChangeset& aChangeset) const;
+    void CollectFootprint(Footprint& aFootprint, const Core::SharedPtr<Red::TweakDBManager>& aManager) const;
+
+    void Serialize(Core::BinaryWriter& aWriter) const;
+    static Core::SharedPtr<TweakFragment> Deserialize(Core::BinaryReader& aReader,
+                                                      const Core::SharedPtr<Red::TweakDBManager>& aManager);
+
+private:
+    static void WriteValue(Core::BinaryWriter& aWriter, const Red::CBaseRTTIType* aType, const void* aValue);
+    static bool ReadValue(Core::BinaryReader& aReader, const Red::CBaseRTTIType* aType, void* aValue);
+
+    Core::Vector<Operation> m_operations;
+    Core::Map<Red::TweakDBID, const Red::CBaseRTTIType*> m_lastFlatExpectations;
+    Core::Map<Red::TweakDBID, const Red::CClass*> m_lastRecordExpectations;
+};
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+namespace App::BundleFormat
+{
+// A bundle is a fragment recorded while reading a set of tweak sources,
+// stored with pre-hashed IDs, resolved type names and values in their native layout.
+//
+// Layout:
+//   uint32 magic
+//   uint32 version
+//   uint64 fingerprint of the game the bundle was compiled for
+//   uint32 number of source files
+//   fragment data
+constexpr uint32_t Magic = 0x424C5854; // TXLB
+constexpr uint32_t Version = 1;
+constexpr auto Extension = L".tweakbin";
+}
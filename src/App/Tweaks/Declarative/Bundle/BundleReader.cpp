@@ -0,0 +1,73 @@
+#include "BundleReader.hpp"
+#include "BundleFormat.hpp"
+
+App::BundleReader::BundleReader(Core::SharedPtr<Red::TweakDBManager> aManager,
+                                Core::SharedPtr<App::TweakContext> aContext)
+    : BaseTweakReader(std::move(aManager), std::move(aContext))
+    , m_fingerprint(0)
+{
+}
+
+bool App::BundleReader::Load(const std::filesystem::path& aPath)
+{
+    if (!m_file.Open(aPath))
+        return false;
+
+    Core::BinaryReader reader(m_file.GetData(), m_file.GetSize());
+
+    if (reader.Read<uint32_t>() != BundleFormat::Magic)
+        throw std::runtime_error("Bad format. The file is not a tweak bundle.");
+
+    if (reader.Read<uint32_t>() != BundleFormat::Version)
+        throw std::runtime_error("The bundle was compiled by an incompatible version and must be recompiled.");
+
+    m_fingerprint = reader.Read<uint64_t>();
+
+    return IsLoaded();
+}
+
+bool App::BundleReader::IsLoaded() const
+{
+    return m_file.IsOpen();
+}
+
+void App::BundleReader::Unload()
+{
+    m_file.Close();
+    m_fingerprint = 0;
+}
+
+void App::BundleReader::Read(App::TweakChangeset& aChangeset)
+{
+    if (!IsLoaded())
+        return;
+
+    Core::BinaryReader reader(m_file.GetData(), m_file.GetSize());
+    reader.Skip(sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint64_t));
+
+    const auto sourceCount = reader.Read<uint32_t>();
+    const auto fragment = TweakFragment::Deserialize(reader, m_manager);
+
+    if (!fragment)
+    {
+        LogError("Bad format. The bundle data is corrupted.");
+        return;
+    }
+
+    // Conditions are resolved at compile time, so the bundle is only valid for the same game state
+    if (m_fingerprint != m_context->GetFingerprint())
+    {
+        LogError("The bundle was compiled for a different game version and must be recompiled.");
+        return;
+    }
+
+    if (!fragment->IsApplicable(aChangeset, m_manager))
+    {
+        LogError("The bundle conflicts with tweaks loaded before it and must be recompiled from sources.");
+        return;
+    }
+
+    fragment->Apply(aChangeset);
+
+    LogInfo("Applied bundle of {} source(s).", sourceCount);
+}
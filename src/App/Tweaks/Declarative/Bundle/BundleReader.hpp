@@ -0,0 +1,23 @@
+#pragma once
+
+#include "App/Tweaks/Declarative/TweakReader.hpp"
+#include "Core/Memory/MappedFile.hpp"
+
+namespace App
+{
+class BundleReader : public BaseTweakReader
+{
+public:
+    BundleReader(Core::SharedPtr<Red::TweakDBManager> aManager, Core::SharedPtr<App::TweakContext> aContext);
+    ~BundleReader() override = default;
+
+    bool Load(const std::filesystem::path& aPath) override;
+    [[nodiscard]] bool IsLoaded() const override;
+    void Unload() override;
+    void Read(TweakChangeset& aChangeset) override;
+
+private:
+    Core::MappedFile m_file;
+    uint64_t m_fingerprint;
+};
+}
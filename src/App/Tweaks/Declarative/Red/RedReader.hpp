@@ -1,15 +1,12 @@
 #pragma once
 
 #include "App/Tweaks/Declarative/TweakReader.hpp"
-#include "Core/Logging/LoggingAgent.hpp"
 #include "Red/TweakDB/Source/Source.hpp"
 #include "Red/Value.hpp"
 
 namespace App
 {
-class RedReader
-    : public BaseTweakReader
-    , public Core::LoggingAgent
+class RedReader : public BaseTweakReader
 {
 public:
     RedReader(Core::SharedPtr<Red::TweakDBManager> aManager, Core::SharedPtr<App::TweakContext> aContext);
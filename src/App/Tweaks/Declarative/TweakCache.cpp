@@ -0,0 +1,252 @@
+#include "TweakCache.hpp"
+
+App::TweakCache::TweakCache(std::filesystem::path aCacheDir)
+    : m_cachePath(std::move(aCacheDir) / FileName)
+    , m_stateHash(0)
+    , m_modified(false)
+{
+}
+
+void App::TweakCache::Load(uint64_t aStateHash)
+{
+    m_stateHash = aStateHash;
+    m_entries.clear();
+    m_usedEntries.clear();
+    m_modified = false;
+
+    Core::Vector<uint8_t> buffer;
+    if (!Core::ReadFile(m_cachePath, buffer))
+        return;
+
+    Core::BinaryReader reader(buffer.data(), buffer.size());
+
+    if (reader.Read<uint32_t>() != Magic || reader.Read<uint32_t>() != Version
+        || reader.Read<uint64_t>() != m_stateHash)
+    {
+        LogInfo("Tweak cache is outdated and will be rebuilt.");
+        m_modified = true;
+        return;
+    }
+
+    const auto entryCount = reader.Read<uint32_t>();
+
+    for (uint32_t i = 0; i < entryCount && !reader.IsFailed(); ++i)
+    {
+        auto key = reader.ReadString();
+
+        auto entry = Core::MakeShared<Entry>();
+        entry->stamp.size = reader.Read<uint64_t>();
+        entry->stamp.modifiedTime = reader.Read<int64_t>();
+        entry->stamp.contentHash = reader.Read<uint64_t>();
+
+        const auto messageCount = reader.Read<uint32_t>();
+        for (uint32_t j = 0; j < messageCount && !reader.IsFailed(); ++j)
+        {
+            const auto level = reader.Read<MessageLevel>();
+            entry->messages.push_back({level, reader.ReadString()});
+        }
+
+        const auto dataSize = reader.Read<uint32_t>();
+        const auto* data = reader.Skip(dataSize);
+
+        if (data)
+        {
+            entry->data.assign(data, data + dataSize);
+            m_entries.insert_or_assign(std::move(key), std::move(entry));
+        }
+    }
+
+    if (reader.IsFailed())
+    {
+        LogWarning("Tweak cache is corrupted and will be rebuilt.");
+        m_entries.clear();
+        m_modified = true;
+    }
+}
+
+void App::TweakCache::Save()
+{
+    if (!m_modified && m_usedEntries.size() == m_entries.size())
+        return;
+
+    Core::BinaryWriter writer;
+    writer.Write(Magic);
+    writer.Write(Version);
+    writer.Write(m_stateHash);
+    writer.Write(static_cast<uint32_t>(m_usedEntries.size()));
+
+    for (const auto& key : m_usedEntries)
+    {
+        const auto& entry = *m_entries[key];
+
+        writer.WriteString(key);
+        writer.Write(entry.stamp.size);
+        writer.Write(entry.stamp.modifiedTime);
+        writer.Write(entry.stamp.contentHash);
+        writer.Write(static_cast<uint32_t>(entry.messages.size()));
+
+        for (const auto& message : entry.messages)
+        {
+            writer.Write(message.level);
+            writer.WriteString(message.text);
+        }
+
+        writer.Write(static_cast<uint32_t>(entry.data.size()));
+        writer.WriteBytes(entry.data.data(), entry.data.size());
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(m_cachePath.parent_path(), error);
+
+    auto tempPath = m_cachePath;
+    tempPath += L".tmp";
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            LogWarning("Can't write tweak cache.");
+            return;
+        }
+
+        file.write(reinterpret_cast<const char*>(writer.GetBuffer().data()),
+                   static_cast<std::streamsize>(writer.GetSize()));
+    }
+
+    std::filesystem::rename(tempPath, m_cachePath, error);
+
+    if (error)
+    {
+        LogWarning("Can't write tweak cache: {}", error.message());
+        return;
+    }
+
+    m_modified = false;
+}
+
+Core::SharedPtr<const App::TweakCache::Entry> App::TweakCache::Find(const std::filesystem::path& aPath, FileStamp& aStamp) const
+{
+    const auto it = m_entries.find(ToKey(aPath));
+
+    if (it == m_entries.end())
+        return nullptr;
+
+    const auto& entry = it->second;
+
+    if (!IsSameFile(aPath, entry->stamp, aStamp))
+        return nullptr;
+
+    return entry;
+}
+
+void App::TweakCache::Keep(const std::filesystem::path& aPath, const FileStamp& aStamp)
+{
+    auto key = ToKey(aPath);
+    auto it = m_entries.find(key);
+
+    if (it == m_entries.end())
+        return;
+
+    auto& entry = it->second;
+
+    if (entry->stamp.modifiedTime != aStamp.modifiedTime)
+    {
+        entry->stamp = aStamp;
+        m_modified = true;
+    }
+
+    m_usedEntries.insert(std::move(key));
+}
+
+void App::TweakCache::Store(const std::filesystem::path& aPath, const FileStamp& aStamp,
+                            const Core::SharedPtr<TweakFragment>& aFragment, Core::Vector<Message>&& aMessages)
+{
+    auto key = ToKey(aPath);
+
+    if (!aFragment)
+    {
+        m_entries.erase(key);
+        m_usedEntries.erase(key);
+        m_modified = true;
+        return;
+    }
+
+    Core::BinaryWriter writer;
+    aFragment->Serialize(writer);
+
+    auto entry = Core::MakeShared<Entry>();
+    entry->stamp = aStamp;
+    entry->messages = std::move(aMessages);
+    entry->data = writer.GetBuffer();
+
+    if (!entry->stamp.contentHash)
+    {
+        entry->stamp.contentHash = ComputeContentHash(aPath);
+    }
+
+    m_entries.insert_or_assign(key, std::move(entry));
+
+    m_usedEntries.insert(std::move(key));
+    m_modified = true;
+}
+
+bool App::TweakCache::GetFileStamp(const std::filesystem::path& aPath, FileStamp& aStamp)
+{
+    std::error_code error;
+
+    const auto size = std::filesystem::file_size(aPath, error);
+    if (error)
+        return false;
+
+    const auto modifiedTime = std::filesystem::last_write_time(aPath, error);
+    if (error)
+        return false;
+
+    aStamp.size = size;
+    aStamp.modifiedTime = modifiedTime.time_since_epoch().count();
+    aStamp.contentHash = 0;
+
+    return true;
+}
+
+bool App::TweakCache::IsSameFile(const std::filesystem::path& aPath, const FileStamp& aKnownStamp,
+                                 FileStamp& aStamp)
+{
+    if (aKnownStamp.size != aStamp.size)
+        return false;
+
+    // Files are often rewritten with the same content by mod managers,
+    // so a different timestamp alone doesn't mean the file has changed.
+    if (aKnownStamp.modifiedTime != aStamp.modifiedTime)
+    {
+        if (!aStamp.contentHash)
+        {
+            aStamp.contentHash = ComputeContentHash(aPath);
+        }
+
+        if (aKnownStamp.contentHash != aStamp.contentHash)
+            return false;
+    }
+
+    aStamp.contentHash = aKnownStamp.contentHash;
+
+    return true;
+}
+
+uint64_t App::TweakCache::ComputeContentHash(const std::filesystem::path& aPath)
+{
+    std::ifstream file(aPath, std::ios::binary);
+    if (!file.is_open())
+        return 0;
+
+    const std::string content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+    return Red::FNV1a64(reinterpret_cast<const uint8_t*>(content.data()), content.size());
+}
+
+std::string App::TweakCache::ToKey(const std::filesystem::path& aPath)
+{
+    std::error_code error;
+    const auto path = std::filesystem::absolute(aPath, error).lexically_normal().generic_u8string();
+    return {path.begin(), path.end()};
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "App/Tweaks/Batch/TweakFragment.hpp"
+#include "Core/Logging/LoggingAgent.hpp"
+
+namespace App
+{
+// Persistent storage of the fragments recorded from tweak sources,
+// allowing to skip parsing of the sources that didn't change since the last run.
+class TweakCache : Core::LoggingAgent
+{
+public:
+    enum class MessageLevel : uint8_t
+    {
+        Info,
+        Warning,
+        Error,
+    };
+
+    struct Message
+    {
+        MessageLevel level;
+        std::string text;
+    };
+
+    struct FileStamp
+    {
+        uint64_t size;
+        int64_t modifiedTime;
+        uint64_t contentHash;
+    };
+
+    struct Entry
+    {
+        FileStamp stamp;
+        Core::Vector<Message> messages;
+        Core::Vector<uint8_t> data;
+    };
+
+    explicit TweakCache(std::filesystem::path aCacheDir);
+
+    void Load(uint64_t aStateHash);
+    void Save();
+
+    Core::SharedPtr<const Entry> Find(const std::filesystem::path& aPath, FileStamp& aStamp) const;
+    void Keep(const std::filesystem::path& aPath, const FileStamp& aStamp);
+    void Store(const std::filesystem::path& aPath, const FileStamp& aStamp,
+               const Core::SharedPtr<TweakFragment>& aFragment, Core::Vector<Message>&& aMessages);
+
+    static bool GetFileStamp(const std::filesystem::path& aPath, FileStamp& aStamp);
+    static bool IsSameFile(const std::filesystem::path& aPath, const FileStamp& aKnownStamp, FileStamp& aStamp);
+    static uint64_t ComputeContentHash(const std::filesystem::path& aPath);
+
+private:
+    static std::string ToKey(const std::filesystem::path& aPath);
+
+    static constexpr uint32_t Magic = 0x434C5854; // TXLC
+    static constexpr uint32_t Version = 1;
+    static constexpr auto FileName = L"tweaks.cache";
+
+    std::filesystem::path m_cachePath;
+    uint64_t m_stateHash;
+    Core::Map<std::string, Core::SharedPtr<Entry>> m_entries;
+    Core::Set<std::string> m_usedEntries;
+    bool m_modified;
+};
+}
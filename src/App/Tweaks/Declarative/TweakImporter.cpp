@@ -1,13 +1,63 @@
 #include "TweakImporter.hpp"
+#include "App/Project.hpp"
 #include "App/Tweaks/Batch/TweakChangeset.hpp"
+#include "App/Tweaks/Declarative/Bundle/BundleFormat.hpp"
+#include "App/Tweaks/Declarative/Bundle/BundleReader.hpp"
 #include "App/Tweaks/Declarative/Yaml/YamlReader.hpp"
 #include "App/Tweaks/Declarative/Red/RedReader.hpp"
+#include "Core/Threading/Parallel.hpp"
+#include "Core/Tracing/Tracer.hpp"
+
+namespace
+{
+// Keeps the messages produced by a single read,
+// so that they can be stored alongside the cached result.
+class LogCapture : public Core::LoggingDriver
+{
+public:
+    void LogInfo(const std::string_view& aMessage) override
+    {
+        m_messages.push_back({App::TweakCache::MessageLevel::Info, std::string(aMessage)});
+    }
+
+    void LogWarning(const std::string_view& aMessage) override
+    {
+        m_messages.push_back({App::TweakCache::MessageLevel::Warning, std::string(aMessage)});
+    }
+
+    void LogError(const std::string_view& aMessage) override
+    {
+        m_messages.push_back({App::TweakCache::MessageLevel::Error, std::string(aMessage)});
+    }
+
+    void LogDebug(const std::string_view&) override
+    {
+    }
+
+    void LogFlush() override
+    {
+    }
+
+    Core::Vector<App::TweakCache::Message>& GetMessages()
+    {
+        return m_messages;
+    }
+
+private:
+    Core::Vector<App::TweakCache::Message> m_messages;
+};
+}
 
 App::TweakImporter::TweakImporter(Core::SharedPtr<Red::TweakDBManager> aManager,
-                                  Core::SharedPtr<App::TweakContext> aContext)
+                                  Core::SharedPtr<App::TweakContext> aContext,
+                                  const std::filesystem::path& aCacheDir)
     : m_manager(std::move(aManager))
     , m_context(std::move(aContext))
 {
+    if (!aCacheDir.empty())
+    {
+        m_cache = Core::MakeShared<TweakCache>(aCacheDir);
+    }
 }
 
 void App::TweakImporter::ImportTweaks(const Core::Vector<std::filesystem::path>& aImportPaths,
@@ -16,81 +66,332 @@ void App::TweakImporter::ImportTweaks(const Core::Vector<std::filesystem::path>&
 {
     try
     {
+        Core::Tracer::Reset();
+
         LogInfo("Scanning for tweaks...");
 
         auto changeset = Core::MakeShared<TweakChangeset>();
+        auto files = CollectFiles(aImportPaths);
 
-        Core::Vector<std::pair<std::filesystem::path, std::filesystem::path>> firstPriorityPaths;
-        Core::Vector<std::pair<std::filesystem::path, std::filesystem::path>> secondPriorityPaths;
-        Core::Vector<std::pair<std::filesystem::path, std::filesystem::path>> lastPriorityPaths;
-        std::error_code error;
+        LoadCache();
+
+        Core::Vector<TweakFile*> pendingFiles;
+        pendingFiles.reserve(files.size());
+
+        for (auto& file : files)
+        {
+            pendingFiles.push_back(&file);
+        }
+
+        PrepareAndRead(pendingFiles, [this, &changeset](TweakFile& aFile) {
+            Read(changeset, aFile);
+        });
 
-        for (const auto& importPath : aImportPaths)
+        SaveCache();
+
+        if (!aDryRun)
         {
-            if (std::filesystem::is_directory(importPath, error))
+            Apply(changeset, aChangelog);
+            RememberSources(files);
+        }
+
+        ReportTrace();
+    }
+    catch (const std::exception& ex)
+    {
+        LogError(ex.what());
+    }
+    catch (...)
+    {
+        LogError("An unknown error occurred while trying to import tweaks.");
+    }
+}
+
+void App::TweakImporter::ImportChangedTweaks(const Core::Vector<std::filesystem::path>& aImportPaths,
+                                             const Core::SharedPtr<App::TweakChangelog>& aChangelog)
+{
+    if (!aChangelog || m_sources.empty())
+    {
+        ImportTweaks(aImportPaths, aChangelog);
+        return;
+    }
+
+    try
+    {
+        Core::Tracer::Reset();
+
+        LogInfo("Scanning for changed tweaks...");
+
+        auto files = CollectFiles(aImportPaths);
+        Core::Vector<TweakSource*> knownSources(files.size(), nullptr);
+
+        Core::TraceScope classifyTrace("import", "Detect changes");
+
+        Core::ParallelFor(files.size(), [this, &files, &knownSources](size_t aIndex) {
+            auto& file = files[aIndex];
+            file.stamped = TweakCache::GetFileStamp(file.path, file.stamp);
+
+            if (file.stamped)
             {
-                const auto dirIt = std::filesystem::recursive_directory_iterator(
-                    importPath, std::filesystem::directory_options::follow_directory_symlink);
-                for (const auto& entry : dirIt)
+                const auto it = m_sources.find(file.path.native());
+                if (it != m_sources.end() && TweakCache::IsSameFile(file.path, it->second.stamp, file.stamp))
                 {
-                    if (entry.is_regular_file())
-                    {
-                        if (IsFirstPriority(entry.path()))
-                        {
-                            firstPriorityPaths.emplace_back(entry.path(), importPath);
-                        }
-                        else if (IsLastPriority(entry.path()))
-                        {
-                            lastPriorityPaths.emplace_back(entry.path(), importPath);
-                        }
-                        else
-                        {
-                            secondPriorityPaths.emplace_back(entry.path(), importPath);
-                        }
-                    }
+                    knownSources[aIndex] = &it.value();
                 }
-                continue;
             }
+        });
+
+        // Everything changed by the removed and modified files must be reverted,
+        // and everything added by the new and modified files must be applied.
+        TweakFragment::Footprint changes;
+        Core::Set<std::filesystem::path::string_type> currentPaths;
+        Core::Vector<size_t> changedFiles;
+        size_t removedCount = 0;
 
-            if (std::filesystem::is_regular_file(importPath, error))
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+            currentPaths.insert(files[i].path.native());
+
+            if (!knownSources[i])
+            {
+                changedFiles.push_back(i);
+            }
+        }
+
+        for (auto it = m_sources.begin(); it != m_sources.end(); ++it)
+        {
+            if (!currentPaths.contains(it->first))
+            {
+                MarkChanged(GetFootprint(it.value()), changes);
+                ++removedCount;
+            }
+        }
+
+        classifyTrace.End();
+
+        if (changedFiles.empty() && removedCount == 0)
+        {
+            LogInfo("No changes found.");
+            return;
+        }
+
+        LoadCache();
+
+        {
+            // The changed files are read into a separate changeset to find out what they change,
+            // before it's known which of the unchanged files have to be applied along with them.
+            auto changeset = Core::MakeShared<TweakChangeset>();
+
+            Core::Vector<TweakFile*> pendingFiles;
+            pendingFiles.reserve(changedFiles.size());
+
+            for (const auto& index : changedFiles)
             {
-                if (IsFirstPriority(importPath))
+                pendingFiles.push_back(&files[index]);
+            }
+
+            PrepareAndRead(pendingFiles, [this, &changeset, &changes](TweakFile& aFile) {
+                const auto it = m_sources.find(aFile.path.native());
+                if (it != m_sources.end())
                 {
-                    firstPriorityPaths.emplace_back(importPath, importPath.parent_path());
+                    MarkChanged(GetFootprint(it.value()), changes);
                 }
-                else if (IsLastPriority(importPath))
+
+                Read(changeset, aFile);
+
+                if (aFile.fragment)
                 {
-                    lastPriorityPaths.emplace_back(importPath, importPath.parent_path());
+                    TweakFragment::Footprint footprint;
+                    aFile.fragment->CollectFootprint(footprint, m_manager);
+                    MarkChanged(footprint, changes);
                 }
-                else
+            });
+        }
+
+        // Reverting a flat also reverts the changes made to it by the unchanged files,
+        // so these files have to be applied again, which can affect even more flats.
+        Core::Vector<bool> affectedFiles(files.size(), false);
+        size_t affectedCount = 0;
+        bool expanded;
+
+        do
+        {
+            expanded = false;
+
+            for (size_t i = 0; i < files.size(); ++i)
+            {
+                if (!knownSources[i] || affectedFiles[i])
+                    continue;
+
+                const auto& footprint = GetFootprint(*knownSources[i]);
+
+                if (IsAffected(footprint, changes))
                 {
-                    secondPriorityPaths.emplace_back(importPath, importPath.parent_path());
+                    MarkChanged(footprint, changes);
+                    affectedFiles[i] = true;
+                    expanded = true;
+                    ++affectedCount;
                 }
+            }
+        }
+        while (expanded);
+
+        LogInfo("Reimporting {} changed, {} removed and {} affected tweaks...",
+                changedFiles.size(), removedCount, affectedCount);
+
+        // The fragments of the changed files were read against the state before the revert,
+        // so they're only reused if everything they depend on is still the same after the revert.
+        {
+            Core::TraceScope trace("import", "Revert");
+            aChangelog->RevertChanges(m_manager, changes.flats, changes.records);
+            aChangelog->ForgetForeignKeys(changes.flats);
+            aChangelog->ForgetResourcePaths(changes.flats);
+        }
+
+        auto changeset = Core::MakeShared<TweakChangeset>();
+
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+            auto& file = files[i];
+
+            if (knownSources[i])
+            {
+                file.fragment = knownSources[i]->fragment;
+
+                if (m_cache)
+                {
+                    m_cache->Keep(file.path, file.stamp);
+                }
+
+                if (!affectedFiles[i])
+                    continue;
+            }
+            else if (!file.fragment)
+            {
                 continue;
             }
 
-            LogWarning("Can't import \"{}\".", importPath.string());
+            if (file.fragment->IsApplicable(*changeset, m_manager))
+            {
+                file.fragment->Apply(*changeset);
+            }
+            else
+            {
+                file.fragment = nullptr;
+                file.cached = nullptr;
+                Load(file);
+                Read(changeset, file);
+            }
         }
 
-        for (const auto& [importPath, importDir] : firstPriorityPaths)
+        SaveCache();
+
         {
-            Read(changeset, importPath, importDir);
+            Core::TraceScope trace("import", "Commit");
+            changeset->CommitChanges(m_manager, aChangelog);
         }
 
-        for (const auto& [importPath, importDir] : secondPriorityPaths)
+        LogInfo("Import completed.");
+
+        RememberSources(files);
+        ReportTrace();
+    }
+    catch (const std::exception& ex)
+    {
+        LogError(ex.what());
+    }
+    catch (...)
+    {
+        LogError("An unknown error occurred while trying to import tweaks.");
+    }
+}
+
+bool App::TweakImporter::CompileBundle(const Core::Vector<std::filesystem::path>& aSourcePaths,
+                                       const std::filesystem::path& aBundlePath)
+{
+    try
+    {
+        LogInfo("Compiling tweak bundle...");
+
+        auto changeset = Core::MakeShared<TweakChangeset>();
+        auto files = CollectFiles(aSourcePaths);
+
+        Core::Vector<TweakFile*> pendingFiles;
+        pendingFiles.reserve(files.size());
+
+        for (auto& file : files)
+        {
+            if (file.path.extension() == BundleFormat::Extension)
+            {
+                LogWarning("Skipping \"{}\", bundles can't be nested.", GetRelativePath(file).string());
+                continue;
+            }
+
+            pendingFiles.push_back(&file);
+        }
+
+        // All sources are recorded as a single fragment, so that the lookups made
+        // by every source are checked again when the bundle is applied.
+        changeset->StartRecording();
+
+        uint32_t sourceCount = 0;
+        uint32_t errorCount = 0;
+
+        PrepareAndRead(pendingFiles, [this, &changeset, &sourceCount, &errorCount](TweakFile& aFile) {
+            LogInfo("Reading \"{}\"...", GetRelativePath(aFile).string());
+
+            if (!aFile.error.empty())
+            {
+                LogError(aFile.error.c_str());
+                ++errorCount;
+                return;
+            }
+
+            if (aFile.loaded)
+            {
+                aFile.reader->Read(*changeset);
+                aFile.reader->Unload();
+                ++sourceCount;
+            }
+        }, false);
+
+        const auto fragment = changeset->FinishRecording();
+
+        if (errorCount > 0)
         {
-            Read(changeset, importPath, importDir);
+            LogError("Bundle is not compiled, {} source(s) failed to load.", errorCount);
+            return false;
         }
 
-        for (const auto& [importPath, importDir] : lastPriorityPaths)
+        if (sourceCount == 0 || changeset->IsEmpty())
         {
-            Read(changeset, importPath, importDir);
+            LogInfo("Nothing to compile.");
+            return false;
         }
 
-        if (!aDryRun)
+        Core::BinaryWriter writer;
+        writer.Write(BundleFormat::Magic);
+        writer.Write(BundleFormat::Version);
+        writer.Write(m_context->GetFingerprint());
+        writer.Write(sourceCount);
+        fragment->Serialize(writer);
+
+        std::error_code error;
+        std::filesystem::create_directories(aBundlePath.parent_path(), error);
+
+        std::ofstream file(aBundlePath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
         {
-            Apply(changeset, aChangelog);
+            LogError("Can't write bundle \"{}\".", aBundlePath.string());
+            return false;
         }
+
+        file.write(reinterpret_cast<const char*>(writer.GetBuffer().data()),
+                   static_cast<std::streamsize>(writer.GetSize()));
+
+        LogInfo("Bundle of {} source(s) saved to \"{}\".", sourceCount, aBundlePath.string());
+
+        return true;
     }
     catch (const std::exception& ex)
     {
@@ -98,49 +399,249 @@ void App::TweakImporter::ImportTweaks(const Core::Vector<std::filesystem::path>&
     }
     catch (...)
     {
-        LogError("An unknown error occurred while trying to import tweaks.");
+        LogError("An unknown error occurred while trying to compile tweaks.");
     }
+
+    return false;
 }
 
-bool App::TweakImporter::Read(const Core::SharedPtr<App::TweakChangeset>& aChangeset,
-                              const std::filesystem::path& aPath,
-                              const std::filesystem::path& aDir)
+Core::Vector<App::TweakImporter::TweakFile> App::TweakImporter::CollectFiles(
+    const Core::Vector<std::filesystem::path>& aImportPaths)
 {
-    Core::SharedPtr<ITweakReader> reader;
+    Core::TraceScope trace("import", "Scan");
+
+    Core::Vector<std::pair<std::filesystem::path, std::filesystem::path>> firstPriorityPaths;
+    Core::Vector<std::pair<std::filesystem::path, std::filesystem::path>> secondPriorityPaths;
+    Core::Vector<std::pair<std::filesystem::path, std::filesystem::path>> lastPriorityPaths;
+    std::error_code error;
 
+    for (const auto& importPath : aImportPaths)
     {
-        const auto ext = aPath.extension();
+        if (std::filesystem::is_directory(importPath, error))
+        {
+            const auto dirIt = std::filesystem::recursive_directory_iterator(
+                importPath, std::filesystem::directory_options::follow_directory_symlink);
+            for (const auto& entry : dirIt)
+            {
+                if (entry.is_regular_file())
+                {
+                    if (IsFirstPriority(entry.path()))
+                    {
+                        firstPriorityPaths.emplace_back(entry.path(), importPath);
+                    }
+                    else if (IsLastPriority(entry.path()))
+                    {
+                        lastPriorityPaths.emplace_back(entry.path(), importPath);
+                    }
+                    else
+                    {
+                        secondPriorityPaths.emplace_back(entry.path(), importPath);
+                    }
+                }
+            }
+            continue;
+        }
 
-        if (ext == L".yaml" || ext == L".yml")
+        if (std::filesystem::is_regular_file(importPath, error))
         {
-            reader = Core::MakeShared<YamlReader>(m_manager, m_context);
+            if (IsFirstPriority(importPath))
+            {
+                firstPriorityPaths.emplace_back(importPath, importPath.parent_path());
+            }
+            else if (IsLastPriority(importPath))
+            {
+                lastPriorityPaths.emplace_back(importPath, importPath.parent_path());
+            }
+            else
+            {
+                secondPriorityPaths.emplace_back(importPath, importPath.parent_path());
+            }
+            continue;
         }
-        else if (ext == L".tweak")
+
+        LogWarning("Can't import \"{}\".", importPath.string());
+    }
+
+    Core::Vector<TweakFile> files;
+    files.reserve(firstPriorityPaths.size() + secondPriorityPaths.size() + lastPriorityPaths.size());
+
+    for (const auto& priorityPaths : {&firstPriorityPaths, &secondPriorityPaths, &lastPriorityPaths})
+    {
+        for (const auto& [importPath, importDir] : *priorityPaths)
         {
-            reader = Core::MakeShared<RedReader>(m_manager, m_context);
+            auto reader = CreateReader(importPath);
+
+            if (reader)
+            {
+                files.push_back({importPath, importDir, std::move(reader)});
+            }
         }
     }
 
-    if (!reader)
+    return files;
+}
+
+Core::SharedPtr<App::ITweakReader> App::TweakImporter::CreateReader(const std::filesystem::path& aPath)
+{
+    const auto ext = aPath.extension();
+
+    if (ext == L".yaml" || ext == L".yml")
     {
-        return false;
+        return Core::MakeShared<YamlReader>(m_manager, m_context);
+    }
+
+    if (ext == L".tweak")
+    {
+        return Core::MakeShared<RedReader>(m_manager, m_context);
+    }
+
+    if (ext == BundleFormat::Extension)
+    {
+        return Core::MakeShared<BundleReader>(m_manager, m_context);
+    }
+
+    return nullptr;
+}
+
+std::filesystem::path App::TweakImporter::GetRelativePath(const TweakFile& aFile)
+{
+    std::error_code error;
+    auto path = std::filesystem::relative(aFile.path, aFile.dir, error);
+    if (path.empty())
+    {
+        path = std::filesystem::absolute(aFile.path, error);
+        path = std::filesystem::relative(path, aFile.dir, error);
     }
 
+    return path;
+}
+
+void App::TweakImporter::Prepare(TweakFile& aFile)
+{
+    aFile.stamped = TweakCache::GetFileStamp(aFile.path, aFile.stamp);
+
+    if (m_cache && aFile.stamped)
+    {
+        aFile.cached = m_cache->Find(aFile.path, aFile.stamp);
+
+        if (aFile.cached)
+            return;
+    }
+
+    Load(aFile);
+}
+
+void App::TweakImporter::Load(TweakFile& aFile)
+{
+    Core::TraceScope trace("load", [&aFile]() {
+        return GetRelativePath(aFile).string();
+    });
+
     try
     {
-        std::error_code error;
-        auto path = std::filesystem::relative(aPath, aDir, error);
-        if (path.empty())
+        aFile.loaded = aFile.reader->Load(aFile.path);
+    }
+    catch (const std::exception& ex)
+    {
+        aFile.error = ex.what();
+    }
+    catch (...)
+    {
+        aFile.error = "An unknown error occurred.";
+    }
+}
+
+void App::TweakImporter::PrepareAndRead(const Core::Vector<TweakFile*>& aFiles,
+                                        const std::function<void(TweakFile&)>& aRead, bool aUseCache)
+{
+    // Parsing of each file doesn't depend on anything but the file itself,
+    // so it can be done in parallel. Reading into the changeset depends on
+    // the changes made by previous files, so it must follow the priority order.
+    // Parsed sources can be large, so only a small window of files is loaded at once,
+    // and every file is unloaded right after it's read.
+    const auto windowSize = Core::GetWorkerCount(aFiles.size()) * LoadWindowFactor;
+
+    for (size_t windowStart = 0; windowStart < aFiles.size(); windowStart += windowSize)
+    {
+        const auto windowEnd = std::min(windowStart + windowSize, aFiles.size());
+
+        Core::ParallelFor(windowEnd - windowStart, [this, &aFiles, windowStart, aUseCache](size_t aIndex) {
+            auto& file = *aFiles[windowStart + aIndex];
+
+            if (aUseCache)
+            {
+                Prepare(file);
+            }
+            else
+            {
+                Load(file);
+            }
+        });
+
+        for (auto i = windowStart; i < windowEnd; ++i)
         {
-            path = std::filesystem::absolute(aPath, error);
-            path = std::filesystem::relative(path, aDir, error);
+            aRead(*aFiles[i]);
         }
+    }
+}
 
-        LogInfo("Reading \"{}\"...", path.string());
+bool App::TweakImporter::Read(const Core::SharedPtr<App::TweakChangeset>& aChangeset, TweakFile& aFile)
+{
+    try
+    {
+        LogInfo("Reading \"{}\"...", GetRelativePath(aFile).string());
 
-        if (reader->Load(aPath))
+        Core::TraceScope trace("read", [&aFile]() {
+            return GetRelativePath(aFile).string();
+        });
+
+        if (aFile.cached)
         {
-            reader->Read(*aChangeset);
+            if (Replay(aChangeset, aFile))
+                return true;
+
+            // The cached result was recorded against a different state of the changeset,
+            // so the source has to be read again.
+            Load(aFile);
+        }
+
+        if (!aFile.error.empty())
+        {
+            LogError(aFile.error.c_str());
+            return false;
+        }
+
+        if (aFile.loaded)
+        {
+            LogCapture capture;
+
+            if (m_cache)
+            {
+                aFile.reader->SetLogSink(&capture);
+            }
+
+            aChangeset->StartRecording();
+
+            try
+            {
+                aFile.reader->Read(*aChangeset);
+            }
+            catch (...)
+            {
+                aChangeset->FinishRecording();
+                aFile.reader->SetLogSink(nullptr);
+                aFile.reader->Unload();
+                throw;
+            }
+
+            aFile.fragment = aChangeset->FinishRecording();
+            aFile.reader->SetLogSink(nullptr);
+            aFile.reader->Unload();
+
+            if (m_cache && aFile.stamped)
+            {
+                m_cache->Store(aFile.path, aFile.stamp, aFile.fragment, std::move(capture.GetMessages()));
+            }
         }
     }
     catch (const std::exception& ex)
@@ -157,6 +658,38 @@ bool App::TweakImporter::Read(const Core::SharedPtr<App::TweakChangeset>& aChang
     return true;
 }
 
+bool App::TweakImporter::Replay(const Core::SharedPtr<App::TweakChangeset>& aChangeset, TweakFile& aFile)
+{
+    Core::BinaryReader reader(aFile.cached->data.data(), aFile.cached->data.size());
+    const auto fragment = TweakFragment::Deserialize(reader, m_manager);
+
+    if (!fragment || !fragment->IsApplicable(*aChangeset, m_manager))
+        return false;
+
+    for (const auto& message : aFile.cached->messages)
+    {
+        switch (message.level)
+        {
+        case TweakCache::MessageLevel::Info:
+            LogInfo(message.text.c_str());
+            break;
+        case TweakCache::MessageLevel::Warning:
+            LogWarning(message.text.c_str());
+            break;
+        case TweakCache::MessageLevel::Error:
+            LogError(message.text.c_str());
+            break;
+        }
+    }
+
+    fragment->Apply(*aChangeset);
+
+    aFile.fragment = fragment;
+    m_cache->Keep(aFile.path, aFile.stamp);
+
+    return true;
+}
+
 bool App::TweakImporter::Apply(const Core::SharedPtr<App::TweakChangeset>& aChangeset,
                                const Core::SharedPtr<App::TweakChangelog>& aChangelog)
 {
@@ -168,13 +701,112 @@ bool App::TweakImporter::Apply(const Core::SharedPtr<App::TweakChangeset>& aChan
 
     LogInfo("Importing tweaks...");
 
-    aChangeset->Commit(m_manager, aChangelog);
+    {
+        Core::TraceScope trace("import", "Commit");
+        aChangeset->Commit(m_manager, aChangelog);
+    }
 
     LogInfo("Import completed.");
 
     return true;
 }
 
+void App::TweakImporter::ReportTrace()
+{
+    Core::Vector<std::string> summary;
+
+    if (!Core::Tracer::Flush(summary))
+        return;
+
+    LogInfo("Import timings:");
+
+    for (const auto& line : summary)
+    {
+        LogInfo(line.c_str());
+    }
+}
+
+void App::TweakImporter::LoadCache()
+{
+    if (!m_cache)
+        return;
+
+    const auto version = Project::Version.to_string();
+    const auto stateHash = Red::FNV1a64(reinterpret_cast<const uint8_t*>(version.data()), version.size(),
+                                        m_context->GetFingerprint());
+
+    m_cache->Load(stateHash);
+}
+
+void App::TweakImporter::SaveCache()
+{
+    if (!m_cache)
+        return;
+
+    m_cache->Save();
+}
+
+void App::TweakImporter::RememberSources(const Core::Vector<TweakFile>& aFiles)
+{
+    Core::Map<std::filesystem::path::string_type, TweakSource> sources;
+
+    for (const auto& file : aFiles)
+    {
+        if (!file.fragment || !file.stamped)
+            continue;
+
+        auto& source = sources[file.path.native()];
+        source.stamp = file.stamp;
+        source.fragment = file.fragment;
+
+        const auto it = m_sources.find(file.path.native());
+        if (it != m_sources.end() && it->second.fragment == file.fragment)
+        {
+            source.footprint = it->second.footprint;
+        }
+    }
+
+    m_sources = std::move(sources);
+}
+
+const App::TweakFragment::Footprint& App::TweakImporter::GetFootprint(TweakSource& aSource)
+{
+    if (!aSource.footprint)
+    {
+        aSource.footprint = Core::MakeShared<TweakFragment::Footprint>();
+        aSource.fragment->CollectFootprint(*aSource.footprint, m_manager);
+    }
+
+    return *aSource.footprint;
+}
+
+bool App::TweakImporter::IsAffected(const TweakFragment::Footprint& aFootprint,
+                                    const TweakFragment::Footprint& aChanges)
+{
+    auto intersects = [](const Core::Set<Red::TweakDBID>& aLeft, const Core::Set<Red::TweakDBID>& aRight) {
+        const auto& smaller = aLeft.size() < aRight.size() ? aLeft : aRight;
+        const auto& larger = aLeft.size() < aRight.size() ? aRight : aLeft;
+
+        for (const auto& id : smaller)
+        {
+            if (larger.contains(id))
+                return true;
+        }
+
+        return false;
+    };
+
+    return intersects(aFootprint.flats, aChanges.flats) || intersects(aFootprint.records, aChanges.records)
+           || intersects(aFootprint.sourceFlats, aChanges.flats)
+           || intersects(aFootprint.sourceRecords, aChanges.records);
+}
+
+void App::TweakImporter::MarkChanged(const TweakFragment::Footprint& aFootprint, TweakFragment::Footprint& aChanges)
+{
+    aChanges.flats.insert(aFootprint.flats.begin(), aFootprint.flats.end());
+    aChanges.records.insert(aFootprint.records.begin(), aFootprint.records.end());
+}
+
 bool App::TweakImporter::IsFirstPriority(const std::filesystem::path& aPath)
 {
     const std::string s_firstPriorityMarkers = "_#$!";
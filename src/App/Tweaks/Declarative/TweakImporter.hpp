@@ -2,6 +2,7 @@
 
 #include "App/Tweaks/Batch/TweakChangelog.hpp"
 #include "App/Tweaks/Batch/TweakChangeset.hpp"
+#include "App/Tweaks/Declarative/TweakCache.hpp"
 #include "App/Tweaks/Declarative/TweakReader.hpp"
 #include "App/Tweaks/TweakContext.hpp"
 #include "Core/Logging/LoggingAgent.hpp"
@@ -12,23 +13,68 @@ namespace App
 class TweakImporter : Core::LoggingAgent
 {
 public:
-    TweakImporter(Core::SharedPtr<Red::TweakDBManager> aManager, Core::SharedPtr<App::TweakContext> aContext);
+    TweakImporter(Core::SharedPtr<Red::TweakDBManager> aManager, Core::SharedPtr<App::TweakContext> aContext,
+                  const std::filesystem::path& aCacheDir = {});
 
     void ImportTweaks(const Core::Vector<std::filesystem::path>& aImportPaths,
                       const Core::SharedPtr<App::TweakChangelog>& aChangelog = nullptr,
                       bool aDryRun = false);
+    void ImportChangedTweaks(const Core::Vector<std::filesystem::path>& aImportPaths,
+                             const Core::SharedPtr<App::TweakChangelog>& aChangelog);
+    bool CompileBundle(const Core::Vector<std::filesystem::path>& aSourcePaths,
+                       const std::filesystem::path& aBundlePath);
 
 private:
-    bool Read(const Core::SharedPtr<App::TweakChangeset>& aChangeset,
-              const std::filesystem::path& aPath,
-              const std::filesystem::path& aDir);
+    struct TweakFile
+    {
+        std::filesystem::path path;
+        std::filesystem::path dir;
+        Core::SharedPtr<ITweakReader> reader;
+        std::string error;
+        bool loaded{false};
+        bool stamped{false};
+        TweakCache::FileStamp stamp{};
+        Core::SharedPtr<const TweakCache::Entry> cached;
+        Core::SharedPtr<TweakFragment> fragment;
+    };
+
+    struct TweakSource
+    {
+        TweakCache::FileStamp stamp;
+        Core::SharedPtr<TweakFragment> fragment;
+        Core::SharedPtr<TweakFragment::Footprint> footprint;
+    };
+
+    Core::Vector<TweakFile> CollectFiles(const Core::Vector<std::filesystem::path>& aImportPaths);
+    Core::SharedPtr<ITweakReader> CreateReader(const std::filesystem::path& aPath);
+    static std::filesystem::path GetRelativePath(const TweakFile& aFile);
+    void Prepare(TweakFile& aFile);
+    static void Load(TweakFile& aFile);
+    void PrepareAndRead(const Core::Vector<TweakFile*>& aFiles, const std::function<void(TweakFile&)>& aRead,
+                        bool aUseCache = true);
+    bool Read(const Core::SharedPtr<App::TweakChangeset>& aChangeset, TweakFile& aFile);
+    bool Replay(const Core::SharedPtr<App::TweakChangeset>& aChangeset, TweakFile& aFile);
     bool Apply(const Core::SharedPtr<App::TweakChangeset>& aChangeset,
                const Core::SharedPtr<App::TweakChangelog>& aChangelog);
 
+    void ReportTrace();
+
+    void LoadCache();
+    void SaveCache();
+
+    void RememberSources(const Core::Vector<TweakFile>& aFiles);
+    const TweakFragment::Footprint& GetFootprint(TweakSource& aSource);
+    static bool IsAffected(const TweakFragment::Footprint& aFootprint, const TweakFragment::Footprint& aChanges);
+    static void MarkChanged(const TweakFragment::Footprint& aFootprint, TweakFragment::Footprint& aChanges);
+
     static bool IsFirstPriority(const std::filesystem::path& aPath);
     static bool IsLastPriority(const std::filesystem::path& aPath);
 
+    static constexpr size_t LoadWindowFactor = 2;
+
     Core::SharedPtr<Red::TweakDBManager> m_manager;
     Core::SharedPtr<App::TweakContext> m_context;
+    Core::SharedPtr<App::TweakCache> m_cache;
+    Core::Map<std::filesystem::path::string_type, TweakSource> m_sources;
 };
 }
@@ -25,6 +25,51 @@ App::BaseTweakReader::BaseTweakReader(Core::SharedPtr<Red::TweakDBManager> aMana
 {
 }
 
+void App::BaseTweakReader::SetLogSink(Core::LoggingDriver* aSink)
+{
+    m_logSink = aSink;
+}
+
+void App::BaseTweakReader::LogInfo(const char* aMessage)
+{
+    Core::LoggingAgent::LogInfo(aMessage);
+
+    if (m_logSink)
+    {
+        m_logSink->LogInfo(aMessage);
+    }
+}
+
+void App::BaseTweakReader::LogWarning(const char* aMessage)
+{
+    Core::LoggingAgent::LogWarning(aMessage);
+
+    if (m_logSink)
+    {
+        m_logSink->LogWarning(aMessage);
+    }
+}
+
+void App::BaseTweakReader::LogError(const char* aMessage)
+{
+    Core::LoggingAgent::LogError(aMessage);
+
+    if (m_logSink)
+    {
+        m_logSink->LogError(aMessage);
+    }
+}
+
+void App::BaseTweakReader::LogDebug(const char* aMessage)
+{
+    Core::LoggingAgent::LogDebug(aMessage);
+
+    if (m_logSink)
+    {
+        m_logSink->LogDebug(aMessage);
+    }
+}
+
 bool App::BaseTweakReader::IsOriginalBaseRecord(Red::TweakDBID aRecordId)
 {
     return m_reflection->IsOriginalBaseRecord(aRecordId);
@@ -118,19 +163,21 @@ std::string App::BaseTweakReader::ComposePath(const std::string& aParentPath, in
 const Red::CBaseRTTIType* App::BaseTweakReader::ResolveFlatInstanceType(App::TweakChangeset& aChangeset,
                                                                         Red::TweakDBID aFlatId)
 {
+    const Red::CBaseRTTIType* resolvedType = nullptr;
+
     const auto existingFlat = m_manager->GetFlat(aFlatId);
     if (existingFlat.instance)
     {
-        return existingFlat.type;
+        resolvedType = existingFlat.type;
     }
-
-    const auto pendingFlat = aChangeset.GetFlat(aFlatId);
-    if (pendingFlat)
+    else if (const auto pendingFlat = aChangeset.GetFlat(aFlatId))
     {
-        return pendingFlat->type;
+        resolvedType = pendingFlat->type;
     }
 
-    return nullptr;
+    aChangeset.TrackFlatLookup(aFlatId, resolvedType);
+
+    return resolvedType;
 }
 
 const Red::CClass* App::BaseTweakReader::ResolveRecordInstanceType(App::TweakChangeset& aChangeset,
@@ -139,19 +186,19 @@ const Red::CClass* App::BaseTweakReader::ResolveRecordInstanceType(App::TweakCha
     if (!aRecordId.IsValid())
         return nullptr;
 
-    const auto existingRecordType = m_manager->GetRecordType(aRecordId);
-    if (existingRecordType)
-    {
-        return existingRecordType;
-    }
+    const Red::CClass* resolvedType = m_manager->GetRecordType(aRecordId);
 
-    const auto pendingRecord = aChangeset.GetRecord(aRecordId);
-    if (pendingRecord)
+    if (!resolvedType)
     {
-        return pendingRecord->type;
+        if (const auto pendingRecord = aChangeset.GetRecord(aRecordId))
+        {
+            resolvedType = pendingRecord->type;
+        }
     }
 
-    return nullptr;
+    aChangeset.TrackRecordLookup(aRecordId, resolvedType);
+
+    return resolvedType;
 }
 
 std::string App::BaseTweakReader::ToName(const Red::CClass* aType)
@@ -2,6 +2,7 @@
 
 #include "App/Tweaks/Batch/TweakChangeset.hpp"
 #include "App/Tweaks/TweakContext.hpp"
+#include "Core/Logging/LoggingAgent.hpp"
 
 namespace App
 {
@@ -13,14 +14,49 @@ public:
     [[nodiscard]] virtual bool IsLoaded() const = 0;
     virtual void Unload() = 0;
     virtual void Read(TweakChangeset& aChangeset) = 0;
+    virtual void SetLogSink(Core::LoggingDriver* aSink) = 0;
 };
 
-class BaseTweakReader : public ITweakReader
+class BaseTweakReader
+    : public ITweakReader
+    , public Core::LoggingAgent
 {
 public:
     BaseTweakReader(Core::SharedPtr<Red::TweakDBManager> aManager, Core::SharedPtr<App::TweakContext> aContext);
 
+    void SetLogSink(Core::LoggingDriver* aSink) override;
+
 protected:
+    // Messages are written to the common log and also passed to the sink of the current read, if any.
+    void LogInfo(const char* aMessage);
+    void LogWarning(const char* aMessage);
+    void LogError(const char* aMessage);
+    void LogDebug(const char* aMessage);
+
+    template<typename... Args>
+    void LogInfo(std::format_string<Args...> aFormat, Args&&... aArgs)
+    {
+        LogInfo(std::format(aFormat, std::forward<Args>(aArgs)...).c_str());
+    }
+
+    template<typename... Args>
+    void LogWarning(std::format_string<Args...> aFormat, Args&&... aArgs)
+    {
+        LogWarning(std::format(aFormat, std::forward<Args>(aArgs)...).c_str());
+    }
+
+    template<typename... Args>
+    void LogError(std::format_string<Args...> aFormat, Args&&... aArgs)
+    {
+        LogError(std::format(aFormat, std::forward<Args>(aArgs)...).c_str());
+    }
+
+    template<typename... Args>
+    void LogDebug(std::format_string<Args...> aFormat, Args&&... aArgs)
+    {
+        LogDebug(std::format(aFormat, std::forward<Args>(aArgs)...).c_str());
+    }
+
     static std::string ComposePath(const std::string& aParentPath, const std::string& aItemName);
     static std::string ComposePath(const std::string& aParentPath, int32_t aItemIndex);
 
@@ -41,5 +77,6 @@ protected:
     Core::SharedPtr<Red::TweakDBReflection> m_reflection;
     Core::SharedPtr<App::TweakContext> m_context;
     Core::Map<std::string, int32_t> m_inlineIndexSuffix;
+    Core::LoggingDriver* m_logSink{nullptr};
 };
 }
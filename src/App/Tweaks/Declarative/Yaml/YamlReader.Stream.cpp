@@ -0,0 +1,346 @@
+#include "YamlReader.hpp"
+
+namespace
+{
+constexpr auto AttrSymbol = '$';
+constexpr auto CommentSymbol = '#';
+constexpr auto DirectiveSymbol = '%';
+constexpr auto DocumentStart = "---";
+
+// Consumes the parser events without building anything,
+// so that the whole document can be checked before any of its entries are applied.
+class SyntaxChecker : public YAML::EventHandler
+{
+public:
+    void OnDocumentStart(const YAML::Mark&) override
+    {
+    }
+
+    void OnDocumentEnd() override
+    {
+    }
+
+    void OnNull(const YAML::Mark&, YAML::anchor_t) override
+    {
+        OnValue(false);
+    }
+
+    void OnAlias(const YAML::Mark&, YAML::anchor_t) override
+    {
+        OnValue(false);
+    }
+
+    void OnScalar(const YAML::Mark&, const std::string&, YAML::anchor_t, const std::string&) override
+    {
+        OnValue(false);
+    }
+
+    void OnSequenceStart(const YAML::Mark&, const std::string&, YAML::anchor_t, YAML::EmitterStyle::value) override
+    {
+        OnValue(false);
+        ++m_depth;
+    }
+
+    void OnSequenceEnd() override
+    {
+        --m_depth;
+    }
+
+    void OnMapStart(const YAML::Mark&, const std::string&, YAML::anchor_t, YAML::EmitterStyle::value) override
+    {
+        OnValue(true);
+        ++m_depth;
+    }
+
+    void OnMapEnd() override
+    {
+        --m_depth;
+    }
+
+    [[nodiscard]] bool IsValid() const
+    {
+        return !m_hasRoot || m_isRootMap;
+    }
+
+private:
+    void OnValue(bool aIsMap)
+    {
+        if (m_depth == 0)
+        {
+            m_hasRoot = true;
+            m_isRootMap = aIsMap;
+        }
+    }
+
+    uint32_t m_depth{0};
+    bool m_hasRoot{false};
+    bool m_isRootMap{false};
+};
+
+// Builds the top level entries of a document from the parser events one by one,
+// passing each completed entry to the callback and releasing it afterwards.
+class TopNodeBuilder : public YAML::EventHandler
+{
+public:
+    using Callback = std::function<void(const std::string&, const YAML::Node&)>;
+
+    explicit TopNodeBuilder(Callback aCallback)
+        : m_callback(std::move(aCallback))
+        , m_ignoredDepth(0)
+    {
+    }
+
+    void OnDocumentStart(const YAML::Mark&) override
+    {
+    }
+
+    void OnDocumentEnd() override
+    {
+    }
+
+    void OnNull(const YAML::Mark&, YAML::anchor_t aAnchor) override
+    {
+        Add(YAML::Node(YAML::NodeType::Null), aAnchor);
+    }
+
+    void OnAlias(const YAML::Mark&, YAML::anchor_t aAnchor) override
+    {
+        Add(m_anchors[aAnchor], YAML::NullAnchor);
+    }
+
+    void OnScalar(const YAML::Mark&, const std::string& aTag, YAML::anchor_t aAnchor,
+                  const std::string& aValue) override
+    {
+        YAML::Node node(aValue);
+        node.SetTag(aTag);
+
+        Add(node, aAnchor);
+    }
+
+    void OnSequenceStart(const YAML::Mark&, const std::string& aTag, YAML::anchor_t aAnchor,
+                         YAML::EmitterStyle::value) override
+    {
+        YAML::Node node(YAML::NodeType::Sequence);
+        node.SetTag(aTag);
+
+        Push(node, aAnchor, false);
+    }
+
+    void OnSequenceEnd() override
+    {
+        Pop();
+    }
+
+    void OnMapStart(const YAML::Mark&, const std::string& aTag, YAML::anchor_t aAnchor,
+                    YAML::EmitterStyle::value) override
+    {
+        YAML::Node node(YAML::NodeType::Map);
+        node.SetTag(aTag);
+
+        Push(node, aAnchor, true);
+    }
+
+    void OnMapEnd() override
+    {
+        Pop();
+    }
+
+private:
+    struct Frame
+    {
+        YAML::Node node;
+        YAML::Node key;
+        bool isMap;
+        bool hasKey;
+    };
+
+    void Add(const YAML::Node& aNode, YAML::anchor_t aAnchor)
+    {
+        if (aAnchor != YAML::NullAnchor)
+        {
+            m_anchors[aAnchor] = aNode;
+        }
+
+        if (m_stack.empty())
+            return;
+
+        auto& frame = m_stack.back();
+
+        if (!frame.isMap)
+        {
+            frame.node.push_back(aNode);
+            return;
+        }
+
+        if (!frame.hasKey)
+        {
+            frame.key = aNode;
+            frame.hasKey = true;
+            return;
+        }
+
+        // The root map itself is never built, its entries go straight to the callback
+        if (m_stack.size() == 1)
+        {
+            m_callback(frame.key.IsScalar() ? frame.key.Scalar() : std::string(), aNode);
+        }
+        else
+        {
+            frame.node.force_insert(frame.key, aNode);
+        }
+
+        frame.key = YAML::Node();
+        frame.hasKey = false;
+    }
+
+    void Push(const YAML::Node& aNode, YAML::anchor_t aAnchor, bool aIsMap)
+    {
+        if (m_stack.empty())
+        {
+            if (!aIsMap)
+            {
+                m_ignoredDepth = 1;
+                return;
+            }
+        }
+        else if (m_ignoredDepth > 0)
+        {
+            ++m_ignoredDepth;
+            return;
+        }
+
+        if (aAnchor != YAML::NullAnchor)
+        {
+            m_anchors[aAnchor] = aNode;
+        }
+
+        m_stack.push_back({aNode, YAML::Node(), aIsMap, false});
+    }
+
+    void Pop()
+    {
+        if (m_ignoredDepth > 0)
+        {
+            --m_ignoredDepth;
+            return;
+        }
+
+        auto node = m_stack.back().node;
+        m_stack.pop_back();
+
+        if (!m_stack.empty())
+        {
+            Add(node, YAML::NullAnchor);
+        }
+    }
+
+    Callback m_callback;
+    Core::Vector<Frame> m_stack;
+    Core::Map<YAML::anchor_t, YAML::Node> m_anchors;
+    uint32_t m_ignoredDepth;
+};
+}
+
+bool App::YamlReader::IsStreamable(const std::filesystem::path& aPath)
+{
+    std::ifstream file(aPath);
+
+    if (!file.is_open())
+        return false;
+
+    // Top level attributes affect the whole file, so they must be known before
+    // the first entry is processed. Only block style documents that declare
+    // attributes at the beginning can be read in a single pass.
+    auto hasEntries = false;
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == ' ' || line[0] == '\t' || line[0] == '\r')
+            continue;
+
+        if (line[0] == CommentSymbol || line[0] == DirectiveSymbol)
+            continue;
+
+        if (line.starts_with(DocumentStart))
+        {
+            if (hasEntries)
+                return false;
+
+            continue;
+        }
+
+        if (line[0] == '{' || line[0] == '[' || line[0] == '-')
+            return false;
+
+        if (line[0] == AttrSymbol)
+        {
+            if (hasEntries)
+                return false;
+
+            continue;
+        }
+
+        hasEntries = true;
+    }
+
+    return true;
+}
+
+void App::YamlReader::ReadStream(App::TweakChangeset& aChangeset)
+{
+    std::ifstream file(m_path);
+
+    if (!file.is_open())
+    {
+        LogError("Can't open the file for reading.");
+        return;
+    }
+
+    // Entries are applied as soon as they're parsed, so the document is checked in a separate pass first,
+    // otherwise a syntax error in the middle of the file would leave the entries before it applied.
+    {
+        SyntaxChecker checker;
+        YAML::Parser parser(file);
+        parser.HandleNextDocument(checker);
+
+        if (!checker.IsValid())
+        {
+            LogError("Bad format. Unexpected data at the top level.");
+            return;
+        }
+    }
+
+    file.clear();
+    file.seekg(0);
+
+    auto propMode = PropertyMode::Strict;
+    auto isSkipped = false;
+
+    TopNodeBuilder builder([&](const std::string& aName, const YAML::Node& aNode) {
+        if (isSkipped)
+            return;
+
+        if (!aName.empty() && aName[0] == AttrSymbol)
+        {
+            YAML::Node attrNode(YAML::NodeType::Map);
+            attrNode[aName] = aNode;
+
+            if (!CheckConditions(attrNode))
+            {
+                isSkipped = true;
+                return;
+            }
+
+            propMode = ResolvePropertyMode(attrNode, propMode);
+            return;
+        }
+
+        ExpandTemplates(aName, aNode, [&](const std::string& aInstanceName, const YAML::Node& aInstanceNode) {
+            HandleTopNode(aChangeset, propMode, aInstanceName, aInstanceNode);
+        });
+    });
+
+    YAML::Parser parser(file);
+    parser.HandleNextDocument(builder);
+}
@@ -289,44 +289,40 @@ void App::YamlReader::ProcessTemplates(YAML::Node& aRootNode)
             continue;
         }
 
-        if (!topNode.IsMap())
-        {
-            ProcessNode(topNode, s_blankInstanceData);
-            expandedNode.force_insert(topKey, topNode);
-            continue;
-        }
+        ExpandTemplates(topKey, topNode, [&expandedNode](const std::string& aName, const YAML::Node& aNode) {
+            expandedNode.force_insert(aName, aNode);
+        });
+    }
 
-        const auto& instanceListNode = topNode[InstanceAttrKey];
+    aRootNode = expandedNode;
+}
 
-        if (!instanceListNode.IsDefined())
-        {
-            ProcessNode(topNode, s_blankInstanceData);
-            expandedNode.force_insert(topKey, topNode);
-            continue;
-        }
+void App::YamlReader::ExpandTemplates(const std::string& aName, const YAML::Node& aNode,
+                                      const std::function<void(const std::string&, const YAML::Node&)>& aCallback)
+{
+    if (aNode.IsMap())
+    {
+        const auto& instanceListNode = aNode[InstanceAttrKey];
 
-        if (instanceListNode.IsSequence())
+        if (instanceListNode.IsDefined() && instanceListNode.IsSequence())
         {
-            const_cast<YAML::Node&>(topNode).remove(InstanceAttrKey);
+            const_cast<YAML::Node&>(aNode).remove(InstanceAttrKey);
 
             for (std::size_t i = 0; i < instanceListNode.size(); ++i)
             {
                 InstanceData instanceData;
                 PrepareInstanceData(instanceData, instanceListNode[i]);
 
-                auto instanceName = FormatString(topKey, instanceData);
-                auto instanceNode = YAML::Clone(topNode);
+                auto instanceName = FormatString(aName, instanceData);
+                auto instanceNode = YAML::Clone(aNode);
                 ProcessNode(instanceNode, instanceData);
 
-                expandedNode.force_insert(instanceName, instanceNode);
+                aCallback(instanceName, instanceNode);
             }
-        }
-        else
-        {
-            ProcessNode(topNode, s_blankInstanceData);
-            expandedNode.force_insert(topKey, topNode);
+            return;
         }
     }
 
-    aRootNode = expandedNode;
+    ProcessNode(aNode, s_blankInstanceData);
+    aCallback(aName, aNode);
 }
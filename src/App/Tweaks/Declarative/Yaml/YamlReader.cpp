@@ -31,18 +31,31 @@ constexpr auto LegacyMembersNodeKey = "members";
 constexpr auto LegacyFlatsNodeKey = "flats";
 constexpr auto LegacyTypeNodeKey = "type";
 constexpr auto LegacyValueNodeKey = "value";
+
+constexpr auto StreamingThreshold = 1024 * 1024;
 }
 
 App::YamlReader::YamlReader(Core::SharedPtr<Red::TweakDBManager> aManager, Core::SharedPtr<App::TweakContext> aContext)
     : BaseTweakReader(std::move(aManager), std::move(aContext))
     , m_path{}
     , m_data{}
+    , m_streaming(false)
 {
 }
 
 bool App::YamlReader::Load(const std::filesystem::path& aPath)
 {
     m_path = aPath;
+
+    // Large files are parsed during reading without building the document tree,
+    // so only the entry being processed is kept in memory.
+    std::error_code error;
+    if (std::filesystem::file_size(aPath, error) >= StreamingThreshold && !error && IsStreamable(aPath))
+    {
+        m_streaming = true;
+        return true;
+    }
+
     m_data = YAML::LoadFile(aPath.string());
 
     return IsLoaded();
@@ -50,13 +63,14 @@ bool App::YamlReader::Load(const std::filesystem::path& aPath)
 
 bool App::YamlReader::IsLoaded() const
 {
-    return m_data.IsDefined() && !m_data.IsNull();
+    return m_streaming || (m_data.IsDefined() && !m_data.IsNull());
 }
 
 void App::YamlReader::Unload()
 {
     m_path = "";
     m_data = YAML::Node();
+    m_streaming = false;
 }
 
 void App::YamlReader::Read(App::TweakChangeset& aChangeset)
@@ -64,6 +78,12 @@ void App::YamlReader::Read(App::TweakChangeset& aChangeset)
     if (!IsLoaded())
         return;
 
+    if (m_streaming)
+    {
+        ReadStream(aChangeset);
+        return;
+    }
+
     if (!m_data.IsMap())
     {
         LogError("Bad format. Unexpected data at the top level.");
@@ -2,13 +2,10 @@
 
 #include "App/Tweaks/Batch/TweakChangeset.hpp"
 #include "App/Tweaks/Declarative/TweakReader.hpp"
-#include "Core/Logging/LoggingAgent.hpp"
 
 namespace App
 {
-class YamlReader
-    : public BaseTweakReader
-    , public Core::LoggingAgent
+class YamlReader : public BaseTweakReader
 {
 public:
     YamlReader(Core::SharedPtr<Red::TweakDBManager> aManager, Core::SharedPtr<App::TweakContext> aContext);
@@ -39,6 +36,9 @@ private:
                          const YAML::Node& aNode, const Red::CBaseRTTIType* aElementType);
     void UpdateFlatOwner(TweakChangeset& aChangeset, const std::string& aName);
 
+    static bool IsStreamable(const std::filesystem::path& aPath);
+    void ReadStream(TweakChangeset& aChangeset);
+
     bool CheckConditions(const YAML::Node& aNode);
     static PropertyMode ResolvePropertyMode(const YAML::Node& aNode, PropertyMode aDefault = PropertyMode::Strict);
     const Red::CBaseRTTIType* ResolveFlatType(const YAML::Node& aNode);
@@ -63,9 +63,12 @@ private:
     std::pair<Red::CName, Red::InstancePtr<>> TryMakeValue(const YAML::Node& aNode);
 
     void ProcessTemplates(YAML::Node& aRootNode);
+    void ExpandTemplates(const std::string& aName, const YAML::Node& aNode,
+                         const std::function<void(const std::string&, const YAML::Node&)>& aCallback);
     void ConvertLegacyNodes();
 
     std::filesystem::path m_path;
     YAML::Node m_data;
+    bool m_streaming;
 };
 }
@@ -1,5 +1,7 @@
 #include "MetadataExporter.hpp"
 #include "App/Tweaks/Declarative/Red/RedReader.hpp"
+#include "App/Tweaks/Metadata/MetadataFormat.hpp"
+#include "Core/Memory/Binary.hpp"
 #include "Red/TweakDB/Manager.hpp"
 #include "Red/TweakDB/Source/Parser.hpp"
 
@@ -10,6 +12,51 @@ constexpr auto SchemaPackage = Red::TweakSource::SchemaPackage;
 constexpr auto NameSeparator = Red::TweakGrammar::Name::Separator;
 constexpr auto InlineSuffix = "_inline";
 constexpr auto DebugTag = "Debug";
+
+template<typename T>
+std::span<const uint8_t> AsBytes(const Core::Vector<T>& aData)
+{
+    return {reinterpret_cast<const uint8_t*>(aData.data()), aData.size() * sizeof(T)};
+}
+
+bool WriteMetadata(const std::filesystem::path& aOutPath, App::MetadataFormat::Kind aKind,
+                   std::initializer_list<std::span<const uint8_t>> aSections)
+{
+    using namespace App::MetadataFormat;
+
+    const auto sectionCount = static_cast<uint32_t>(aSections.size());
+
+    Core::BinaryWriter body;
+    uint64_t offset = sizeof(Header) + sectionCount * sizeof(Section);
+
+    for (const auto& section : aSections)
+    {
+        offset = (offset + SectionAlignment - 1) & ~(SectionAlignment - 1);
+        body.Write(Section{offset, section.size()});
+        offset += section.size();
+    }
+
+    for (const auto& section : aSections)
+    {
+        while ((sizeof(Header) + body.GetSize()) % SectionAlignment != 0)
+            body.Write<uint8_t>(0);
+
+        body.WriteBytes(section.data(), section.size());
+    }
+
+    Header header{};
+    header.magic = Magic;
+    header.version = Version;
+    header.kind = aKind;
+    header.sectionCount = sectionCount;
+    header.checksum = Red::FNV1a64(body.GetBuffer().data(), body.GetSize());
+
+    std::ofstream out(aOutPath, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(body.GetBuffer().data()), static_cast<std::streamsize>(body.GetSize()));
+
+    return out.good();
+}
 }
 
 App::MetadataExporter::MetadataExporter(Core::SharedPtr<Red::TweakDBManager> aManager)
@@ -238,26 +285,44 @@ bool App::MetadataExporter::ExportInheritanceMap(const std::filesystem::path& aO
 
     if (aOutPath.extension() == ".dat")
     {
-        std::ofstream out(aOutPath, std::ios::binary);
-
-        auto numberOfEntries = map.size();
-        out.write(reinterpret_cast<char*>(&numberOfEntries), sizeof(numberOfEntries));
+        // The arrays are written in the final sorted layout, so that they can be used without processing
+        Core::Vector<Red::TweakDBInheritanceLink> links;
 
         for (const auto& [recordName, childNames] : map)
         {
-            auto recordID = Red::TweakDBID(recordName);
-            auto numberOfChildren = childNames.size();
-
-            out.write(reinterpret_cast<char*>(&recordID), sizeof(recordID));
-            out.write(reinterpret_cast<char*>(&numberOfChildren), sizeof(numberOfChildren));
+            const auto recordID = Red::TweakDBID(recordName);
 
             for (const auto& childName : childNames)
             {
-                auto childID = Red::TweakDBID(childName);
+                links.push_back({Red::TweakDBID(childName), recordID});
+            }
+        }
 
-                out.write(reinterpret_cast<char*>(&childID), sizeof(childID));
+        std::ranges::sort(links, {}, [](const Red::TweakDBInheritanceLink& aLink) {
+            return std::pair(aLink.parentId.value, aLink.recordId.value);
+        });
+
+        Core::Vector<Red::TweakDBID> baseIds;
+        Core::Vector<uint32_t> offsets;
+        Core::Vector<Red::TweakDBID> descendantIds;
+
+        for (const auto& link : links)
+        {
+            if (baseIds.empty() || baseIds.back() != link.parentId)
+            {
+                baseIds.push_back(link.parentId);
+                offsets.push_back(static_cast<uint32_t>(descendantIds.size()));
             }
+
+            descendantIds.push_back(link.recordId);
         }
+
+        offsets.push_back(static_cast<uint32_t>(descendantIds.size()));
+
+        std::ranges::sort(links, {}, [](const Red::TweakDBInheritanceLink& aLink) { return aLink.recordId.value; });
+
+        return WriteMetadata(aOutPath, MetadataFormat::Kind::InheritanceMap,
+                             {AsBytes(baseIds), AsBytes(offsets), AsBytes(descendantIds), AsBytes(links)});
     }
     else if (aOutPath.extension() == ".yaml")
     {
@@ -326,35 +391,34 @@ bool App::MetadataExporter::ExportExtraFlats(const std::filesystem::path& aOutPa
 
     if (aOutPath.extension() == ".dat")
     {
-        std::ofstream out(aOutPath, std::ios::binary);
-
-        auto numberOfEntries = extras.size();
-        out.write(reinterpret_cast<char*>(&numberOfEntries), sizeof(numberOfEntries));
+        Core::Vector<MetadataFormat::ExtraFlatRecord> records;
+        Core::Vector<MetadataFormat::ExtraFlat> flats;
+        Core::Vector<char> names;
 
         for (const auto& [schemaName, extraFlats] : extras)
         {
             std::string_view typeName = schemaName;
             typeName.remove_prefix(std::char_traits<char>::length(SchemaPackage) + 1);
 
-            auto recordType = m_reflection->GetRecordFullName(typeName.data());
-            auto numberOfFlats = extraFlats.size();
-
-            out.write(reinterpret_cast<char*>(&recordType), sizeof(recordType));
-            out.write(reinterpret_cast<char*>(&numberOfFlats), sizeof(numberOfFlats));
+            auto& record = records.emplace_back();
+            record.recordType = m_reflection->GetRecordFullName(typeName.data());
+            record.firstFlat = static_cast<uint32_t>(flats.size());
+            record.flatCount = static_cast<uint32_t>(extraFlats.size());
 
             for (const auto& [_, flat] : extraFlats)
             {
-                uint8_t flatNameLen = flat->name.size();
-                auto flatName = flat->name.data();
-                auto flatType = RedReader::GetFlatTypeName(flat);
-                auto foreignType = m_reflection->GetRecordFullName(flat->foreignType.data());
-
-                out.write(reinterpret_cast<char*>(&flatNameLen), sizeof(flatNameLen));
-                out.write(reinterpret_cast<char*>(flatName), flatNameLen);
-                out.write(reinterpret_cast<char*>(&flatType), sizeof(flatType));
-                out.write(reinterpret_cast<char*>(&foreignType), sizeof(foreignType));
+                auto& entry = flats.emplace_back();
+                entry.propType = RedReader::GetFlatTypeName(flat);
+                entry.foreignType = m_reflection->GetRecordFullName(flat->foreignType.data());
+                entry.nameOffset = static_cast<uint32_t>(names.size());
+                entry.nameLength = static_cast<uint32_t>(flat->name.size());
+
+                names.insert(names.end(), flat->name.begin(), flat->name.end());
             }
         }
+
+        return WriteMetadata(aOutPath, MetadataFormat::Kind::ExtraFlats,
+                             {AsBytes(records), AsBytes(flats), AsBytes(names)});
     }
     else if (aOutPath.extension() == ".yaml")
     {
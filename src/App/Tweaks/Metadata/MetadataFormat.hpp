@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Red/TweakDB/Reflection.hpp"
+
+namespace App::MetadataFormat
+{
+// Binary metadata is stored as a set of flat arrays that can be used directly from a mapped file.
+//
+// Layout:
+//   Header
+//   Section[sectionCount]
+//   section data, every section is aligned to 8 bytes
+//
+// Inheritance map sections:
+//   TweakDBID[]            sorted base record IDs
+//   uint32[]               offsets of the descendants of every base record, plus the end offset
+//   TweakDBID[]            descendant IDs, sorted within every base record
+//   TweakDBInheritanceLink sorted by record ID
+//
+// Extra flats sections:
+//   ExtraFlatRecord[]
+//   ExtraFlat[]
+//   char[]                 property names
+constexpr uint32_t Magic = 0x4D4C5854; // TXLM
+constexpr uint32_t Version = 2;
+constexpr size_t SectionAlignment = 8;
+
+enum class Kind : uint32_t
+{
+    InheritanceMap = 1,
+    ExtraFlats = 2,
+};
+
+namespace InheritanceSection
+{
+enum : uint32_t
+{
+    BaseIds,
+    Offsets,
+    DescendantIds,
+    Parents,
+    Count
+};
+}
+
+namespace ExtraFlatSection
+{
+enum : uint32_t
+{
+    Records,
+    Flats,
+    Names,
+    Count
+};
+}
+
+struct Header
+{
+    uint32_t magic;
+    uint32_t version;
+    Kind kind;
+    uint32_t sectionCount;
+    uint64_t checksum; // FNV-1a 64 of everything following the header
+};
+
+struct Section
+{
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct ExtraFlatRecord
+{
+    Red::CName recordType;
+    uint32_t firstFlat;
+    uint32_t flatCount;
+};
+
+struct ExtraFlat
+{
+    Red::CName propType;
+    Red::CName foreignType;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+};
+}
@@ -1,4 +1,5 @@
 #include "MetadataImporter.hpp"
+#include "Core/Memory/Binary.hpp"
 
 App::MetadataImporter::MetadataImporter(Core::SharedPtr<Red::TweakDBManager> aManager)
     : m_manager(std::move(aManager))
@@ -14,36 +15,35 @@ bool App::MetadataImporter::ImportInheritanceMap(const std::filesystem::path& aP
 
     if (aPath.extension() == ".dat")
     {
-        std::ifstream in(aPath, std::ios::binary);
-
-        size_t numberOfEntries;
-        in.read(reinterpret_cast<char*>(&numberOfEntries), sizeof(numberOfEntries));
+        Core::MappedFile file;
+        if (!file.Open(aPath))
+            return false;
 
-        while (numberOfEntries > 0)
-        {
-            Red::TweakDBID recordID;
-            size_t numberOfChildren;
+        if (IsVersionedFormat(file))
+            return ReadInheritanceMap(file);
 
-            in.read(reinterpret_cast<char*>(&recordID), sizeof(recordID));
-            in.read(reinterpret_cast<char*>(&numberOfChildren), sizeof(numberOfChildren));
+        // Legacy layout: a list of base records, each followed by its descendants
+        Core::BinaryReader reader(file.GetData(), file.GetSize());
 
-            Core::Set<Red::TweakDBID> descendantIDs;
+        auto numberOfEntries = reader.Read<uint64_t>();
 
-            while (numberOfChildren > 0)
-            {
-                Red::TweakDBID descendantID;
-                in.read(reinterpret_cast<char*>(&descendantID), sizeof(descendantID));
-                descendantIDs.insert(descendantID);
+        while (numberOfEntries > 0 && !reader.IsFailed())
+        {
+            const auto recordID = reader.Read<Red::TweakDBID>();
+            const auto numberOfChildren = reader.Read<uint64_t>();
+            const auto* descendantIDs = reader.Skip(numberOfChildren * sizeof(Red::TweakDBID));
 
-                --numberOfChildren;
-            }
+            if (!descendantIDs)
+                return false;
 
-            m_reflection->RegisterDescendants(recordID, descendantIDs);
+            // All fields are 8 bytes wide, so the IDs are properly aligned in the mapped file
+            m_reflection->RegisterDescendants(
+                recordID, {reinterpret_cast<const Red::TweakDBID*>(descendantIDs), numberOfChildren});
 
             --numberOfEntries;
         }
 
-        return true;
+        return !reader.IsFailed();
     }
 
     if (aPath.extension() == ".yaml")
@@ -98,30 +98,32 @@ bool App::MetadataImporter::ImportExtraFlats(const std::filesystem::path& aPath)
 
     if (aPath.extension() == ".dat")
     {
-        std::ifstream in(aPath, std::ios::binary);
+        Core::MappedFile file;
+        if (!file.Open(aPath))
+            return false;
 
-        size_t numberOfEntries;
-        in.read(reinterpret_cast<char*>(&numberOfEntries), sizeof(numberOfEntries));
+        if (IsVersionedFormat(file))
+            return ReadExtraFlats(file);
 
-        while (numberOfEntries > 0)
-        {
-            Red::CName recordType;
-            size_t numberOfFlats;
+        // Legacy layout: a list of record types, each followed by its extra flats
+        Core::BinaryReader reader(file.GetData(), file.GetSize());
 
-            in.read(reinterpret_cast<char*>(&recordType), sizeof(recordType));
-            in.read(reinterpret_cast<char*>(&numberOfFlats), sizeof(numberOfFlats));
+        auto numberOfEntries = reader.Read<uint64_t>();
 
-            while (numberOfFlats > 0)
+        while (numberOfEntries > 0 && !reader.IsFailed())
+        {
+            const auto recordType = reader.Read<Red::CName>();
+            auto numberOfFlats = reader.Read<uint64_t>();
+
+            while (numberOfFlats > 0 && !reader.IsFailed())
             {
-                uint8_t propNameLen;
-                char propName[254];
-                Red::CName propType;
-                Red::CName foreignType;
+                const auto propNameLen = reader.Read<uint8_t>();
+                const auto* propName = reinterpret_cast<const char*>(reader.Skip(propNameLen));
+                const auto propType = reader.Read<Red::CName>();
+                const auto foreignType = reader.Read<Red::CName>();
 
-                in.read(reinterpret_cast<char*>(&propNameLen), sizeof(propNameLen));
-                in.read(reinterpret_cast<char*>(&propName), propNameLen);
-                in.read(reinterpret_cast<char*>(&propType), sizeof(propType));
-                in.read(reinterpret_cast<char*>(&foreignType), sizeof(foreignType));
+                if (reader.IsFailed())
+                    return false;
 
                 m_reflection->RegisterExtraFlat(recordType, {propName, propNameLen}, propType, foreignType);
 
@@ -131,7 +133,7 @@ bool App::MetadataImporter::ImportExtraFlats(const std::filesystem::path& aPath)
             --numberOfEntries;
         }
 
-        return true ;
+        return !reader.IsFailed();
     }
 
     if (aPath.extension() == ".yaml")
@@ -194,3 +196,125 @@ bool App::MetadataImporter::ImportExtraFlats(const std::filesystem::path& aPath)
 
     return false;
 }
+
+bool App::MetadataImporter::IsVersionedFormat(const Core::MappedFile& aFile)
+{
+    if (aFile.GetSize() < sizeof(MetadataFormat::Header))
+        return false;
+
+    const auto* header = reinterpret_cast<const MetadataFormat::Header*>(aFile.GetData());
+
+    return header->magic == MetadataFormat::Magic;
+}
+
+std::span<const App::MetadataFormat::Section> App::MetadataImporter::ReadSections(const Core::MappedFile& aFile,
+                                                                                  MetadataFormat::Kind aKind,
+                                                                                  uint32_t aSectionCount)
+{
+    const auto* data = aFile.GetData();
+    const auto size = aFile.GetSize();
+    const auto* header = reinterpret_cast<const MetadataFormat::Header*>(data);
+
+    if (header->kind != aKind || header->sectionCount != aSectionCount)
+    {
+        LogError("Metadata file has unexpected layout (kind {}, {} sections).", static_cast<uint32_t>(header->kind),
+                 header->sectionCount);
+        return {};
+    }
+
+    if (header->version != MetadataFormat::Version)
+    {
+        LogError("Metadata file has unsupported format version {}, expected {}. Reinstall the mod to restore it.",
+                 header->version, MetadataFormat::Version);
+        return {};
+    }
+
+    const auto tableSize = aSectionCount * sizeof(MetadataFormat::Section);
+
+    if (size < sizeof(MetadataFormat::Header) + tableSize)
+    {
+        LogError("Metadata file is truncated.");
+        return {};
+    }
+
+    if (Red::FNV1a64(data + sizeof(MetadataFormat::Header), size - sizeof(MetadataFormat::Header))
+        != header->checksum)
+    {
+        LogError("Metadata file is corrupted: checksum mismatch.");
+        return {};
+    }
+
+    const std::span sections{reinterpret_cast<const MetadataFormat::Section*>(header + 1), aSectionCount};
+
+    for (const auto& section : sections)
+    {
+        if (section.offset % MetadataFormat::SectionAlignment != 0 || section.offset > size
+            || section.size > size - section.offset)
+        {
+            LogError("Metadata file is corrupted: section is out of bounds.");
+            return {};
+        }
+    }
+
+    return sections;
+}
+
+template<typename T>
+std::span<const T> App::MetadataImporter::GetSectionData(const Core::MappedFile& aFile,
+                                                         const MetadataFormat::Section& aSection)
+{
+    return {reinterpret_cast<const T*>(aFile.GetData() + aSection.offset), aSection.size / sizeof(T)};
+}
+
+bool App::MetadataImporter::ReadInheritanceMap(const Core::MappedFile& aFile)
+{
+    using namespace MetadataFormat;
+
+    const auto sections = ReadSections(aFile, Kind::InheritanceMap, InheritanceSection::Count);
+
+    if (sections.empty())
+        return false;
+
+    const auto baseIds = GetSectionData<Red::TweakDBID>(aFile, sections[InheritanceSection::BaseIds]);
+    const auto offsets = GetSectionData<uint32_t>(aFile, sections[InheritanceSection::Offsets]);
+    const auto descendantIds = GetSectionData<Red::TweakDBID>(aFile, sections[InheritanceSection::DescendantIds]);
+    const auto parents = GetSectionData<Red::TweakDBInheritanceLink>(aFile, sections[InheritanceSection::Parents]);
+
+    if (offsets.size() != baseIds.size() + 1 || offsets.back() != descendantIds.size())
+        return false;
+
+    m_reflection->LoadInheritanceMap(baseIds, offsets, descendantIds, parents);
+
+    return true;
+}
+
+bool App::MetadataImporter::ReadExtraFlats(const Core::MappedFile& aFile)
+{
+    using namespace MetadataFormat;
+
+    const auto sections = ReadSections(aFile, Kind::ExtraFlats, ExtraFlatSection::Count);
+
+    if (sections.empty())
+        return false;
+
+    const auto records = GetSectionData<ExtraFlatRecord>(aFile, sections[ExtraFlatSection::Records]);
+    const auto flats = GetSectionData<ExtraFlat>(aFile, sections[ExtraFlatSection::Flats]);
+    const auto names = GetSectionData<char>(aFile, sections[ExtraFlatSection::Names]);
+
+    for (const auto& record : records)
+    {
+        if (record.firstFlat > flats.size() || record.flatCount > flats.size() - record.firstFlat)
+            return false;
+
+        for (const auto& flat : flats.subspan(record.firstFlat, record.flatCount))
+        {
+            if (flat.nameOffset > names.size() || flat.nameLength > names.size() - flat.nameOffset)
+                return false;
+
+            m_reflection->RegisterExtraFlat(record.recordType, {names.data() + flat.nameOffset, flat.nameLength},
+                                            flat.propType, flat.foreignType);
+        }
+    }
+
+    return true;
+}
@@ -1,10 +1,13 @@
 #pragma once
 
+#include "App/Tweaks/Metadata/MetadataFormat.hpp"
+#include "Core/Logging/LoggingAgent.hpp"
+#include "Core/Memory/MappedFile.hpp"
 #include "Red/TweakDB/Manager.hpp"
 
 namespace App
 {
-class MetadataImporter
+class MetadataImporter : Core::LoggingAgent
 {
 public:
     MetadataImporter(Core::SharedPtr<Red::TweakDBManager> aManager);
@@ -13,6 +16,16 @@ public:
     bool ImportExtraFlats(const std::filesystem::path& aPath);
 
 private:
+    bool ReadInheritanceMap(const Core::MappedFile& aFile);
+    bool ReadExtraFlats(const Core::MappedFile& aFile);
+
+    static bool IsVersionedFormat(const Core::MappedFile& aFile);
+    std::span<const MetadataFormat::Section> ReadSections(const Core::MappedFile& aFile, MetadataFormat::Kind aKind,
+                                                          uint32_t aSectionCount);
+
+    template<typename T>
+    static std::span<const T> GetSectionData(const Core::MappedFile& aFile, const MetadataFormat::Section& aSection);
+
     Core::SharedPtr<Red::TweakDBManager> m_manager;
     Core::SharedPtr<Red::TweakDBReflection> m_reflection;
 };
@@ -30,6 +30,15 @@ public:
         return aCondition.empty();
     }
 
+    // Identifies the state that conditions are checked against.
+    [[nodiscard]] inline uint64_t GetFingerprint() const
+    {
+        const auto version = m_gameVersion.to_string();
+        auto hash = Red::FNV1a64(reinterpret_cast<const uint8_t*>(version.data()), version.size());
+        hash = Red::FNV1a64(reinterpret_cast<const uint8_t*>(&m_isEpisodeOne), sizeof(m_isEpisodeOne), hash);
+        return hash;
+    }
+
 private:
     semver::version m_gameVersion;
     bool m_isEpisodeOne;
@@ -1,19 +1,29 @@
 #include "TweakService.hpp"
+#include "App/Project.hpp"
 #include "App/Tweaks/Declarative/TweakImporter.hpp"
 #include "App/Tweaks/Executable/TweakExecutor.hpp"
 #include "App/Tweaks/Metadata/MetadataExporter.hpp"
 #include "App/Tweaks/Metadata/MetadataImporter.hpp"
 #include "Red/TweakDB/Raws.hpp"
 
+namespace
+{
+// Values replaced while loading the tweaks are left in the flat buffer
+constexpr size_t LoadCompactionThreshold = 1024 * 1024;
+}
+
 App::TweakService::TweakService(const Core::SemvVer& aProductVer, std::filesystem::path aGameDir,
                                 std::filesystem::path aTweaksDir, std::filesystem::path aInheritanceMapPath,
-                                std::filesystem::path aExtraFlatsPath, std::filesystem::path aSourcesDir)
+                                std::filesystem::path aExtraFlatsPath, std::filesystem::path aSourcesDir,
+                                std::filesystem::path aCacheDir)
     : m_gameDir(std::move(aGameDir))
     , m_tweaksDir(std::move(aTweaksDir))
     , m_sourcesDir(std::move(aSourcesDir))
+    , m_cacheDir(std::move(aCacheDir))
     , m_inheritanceMapPath(std::move(aInheritanceMapPath))
     , m_extraFlatsPath(std::move(aExtraFlatsPath))
     , m_productVer(aProductVer)
+    , m_isDatabaseLive(false)
 {
     m_importPaths.push_back(m_tweaksDir);
 }
@@ -25,23 +35,48 @@ void App::TweakService::OnBootstrap()
     HookAfter<Raw::TryLoadTweakDB>([&](bool& aSuccess) {
         if (aSuccess)
         {
+            m_isDatabaseLive = false;
+
             m_reflection = Core::MakeShared<Red::TweakDBReflection>();
             m_manager = Core::MakeShared<Red::TweakDBManager>(m_reflection);
+
+            if (!m_cacheDir.empty())
+            {
+                const auto version = Project::Version.to_string();
+                const auto versionHash = Red::FNV1a64(reinterpret_cast<const uint8_t*>(version.data()),
+                                                      version.size());
+
+                m_manager->SetBufferSnapshotPath(m_cacheDir / L"flatpool.snapshot", versionHash);
+                m_reflection->SetCachePath(m_cacheDir / L"reflection.cache");
+            }
+
             m_context = Core::MakeShared<App::TweakContext>(m_productVer);
-            m_importer = Core::MakeShared<App::TweakImporter>(m_manager, m_context);
+            m_importer = Core::MakeShared<App::TweakImporter>(m_manager, m_context, m_cacheDir);
             m_executor = Core::MakeShared<App::TweakExecutor>(m_manager);
             m_changelog = Core::MakeShared<App::TweakChangelog>();
 
             if (ImportMetadata())
             {
+                // Extra flats from the metadata are added to the cached record types
+                m_reflection->LoadCache();
+
+                WarmUpReflection();
+                BuildReferenceIndex();
+
                 EnsureRuntimeAccess();
                 ApplyPatches();
                 LoadTweaks(false);
+                CompactBuffer(LoadCompactionThreshold);
+
+                m_reflection->SaveCache();
             }
         }
     });
 
     HookAfter<Raw::InitTweakDB>([&]() {
+        // From now on the game and scripts hold pointers to the flat values
+        m_isDatabaseLive = true;
+
         EnsureRuntimeAccess();
         CheckForIssues();
     });
@@ -61,6 +96,20 @@ void App::TweakService::LoadTweaks(bool aCheckForIssues)
     }
 }
 
+void App::TweakService::LoadChangedTweaks(bool aCheckForIssues)
+{
+    if (m_manager)
+    {
+        m_importer->ImportChangedTweaks(m_importPaths, m_changelog);
+        m_executor->ExecuteTweaks();
+
+        if (aCheckForIssues)
+        {
+            m_changelog->CheckForIssues(m_manager);
+        }
+    }
+}
+
 void App::TweakService::ImportTweaks()
 {
     if (m_manager)
@@ -69,6 +118,78 @@ void App::TweakService::ImportTweaks()
     }
 }
 
+bool App::TweakService::CompileBundle(std::filesystem::path aSourcePath, std::filesystem::path aBundlePath)
+{
+    if (!m_manager)
+        return false;
+
+    if (aSourcePath.is_relative())
+    {
+        aSourcePath = m_gameDir / aSourcePath;
+    }
+
+    if (aBundlePath.empty())
+    {
+        LogError("Can't compile tweak bundle, the output path is not specified.");
+        return false;
+    }
+
+    if (aBundlePath.is_relative())
+    {
+        aBundlePath = m_gameDir / aBundlePath;
+    }
+
+    std::error_code error;
+    if (!std::filesystem::exists(aSourcePath, error))
+    {
+        LogError("Can't compile non-existing tweak source \"{}\".",
+                 std::filesystem::relative(aSourcePath, m_gameDir).string());
+        return false;
+    }
+
+    // A bundle saved to the import paths would be imported along with its own sources
+    if (IsImportPath(aBundlePath))
+    {
+        LogError("Can't save tweak bundle to \"{}\", the bundle must be placed outside of the tweaks directories.",
+                 std::filesystem::relative(aBundlePath, m_gameDir).string());
+        return false;
+    }
+
+    // The bundle is checked against the original database when it's applied at the next launch,
+    // so it must be compiled against the same state, without the currently loaded tweaks.
+    m_changelog->RevertChanges(m_manager);
+    m_changelog->ForgetForeignKeys();
+    m_changelog->ForgetResourcePaths();
+
+    const auto success = m_importer->CompileBundle({aSourcePath}, aBundlePath);
+
+    LoadTweaks(false);
+
+    return success;
+}
+
+bool App::TweakService::IsImportPath(const std::filesystem::path& aPath)
+{
+    std::error_code error;
+    const auto path = std::filesystem::weakly_canonical(aPath, error);
+
+    for (const auto& importPath : m_importPaths)
+    {
+        auto importDir = std::filesystem::weakly_canonical(importPath, error);
+        if (!importDir.has_filename())
+        {
+            importDir = importDir.parent_path();
+        }
+
+        const auto [importIt, pathIt] = std::mismatch(importDir.begin(), importDir.end(), path.begin(), path.end());
+
+        if (importIt == importDir.end())
+            return true;
+    }
+
+    return false;
+}
+
 void App::TweakService::ExecuteTweaks()
 {
     if (m_manager)
@@ -110,6 +231,65 @@ void App::TweakService::CheckForIssues()
     }
 }
 
+void App::TweakService::CompactBuffer(size_t aMinGarbageSize)
+{
+    if (m_manager && m_changelog)
+    {
+        if (m_isDatabaseLive)
+        {
+            LogWarning("Can't compact the flat buffer after the game initialized the database.");
+            return;
+        }
+
+        if (m_manager->HasOpenBatches())
+        {
+            LogWarning("Can't compact the flat buffer while tweaks are being applied.");
+            return;
+        }
+
+        auto valueRefs = m_changelog->GetValueRefs();
+        const auto result = m_manager->CompactBuffer(valueRefs, aMinGarbageSize);
+
+        if (result.reclaimedSize > 0)
+        {
+            LogInfo("Flat buffer compacted: {} KiB reclaimed, {} values released, {} values moved in {:.3f} ms.",
+                    result.reclaimedSize / 1024, result.releasedValues, result.movedValues, result.compactionTime);
+        }
+    }
+}
+
+void App::TweakService::DumpBufferStats()
+{
+    if (!m_manager)
+        return;
+
+    const auto stats = m_manager->GetBufferStats();
+    const auto hitRate = stats.allocations
+                             ? 100.0f * static_cast<float>(stats.allocationHits) / static_cast<float>(stats.allocations)
+                             : 0.0f;
+
+    LogInfo("Flat buffer: {} KiB total, {} KiB base, {} KiB added, {} KiB from snapshot.",
+            stats.poolSize / 1024, stats.baseSize / 1024, stats.addedSize / 1024, stats.snapshotSize / 1024);
+    LogInfo("Flat pools: {} values, {} flats, {} known types, {:.2f} load factor.",
+            stats.poolValues, stats.flatEntries, stats.knownTypes, stats.poolLoadFactor);
+    LogInfo("Flat allocations: {} requested, {} pooled ({:.1f}% hit rate).",
+            stats.allocations, stats.allocationHits, hitRate);
+
+    const auto commitStats = m_manager->GetCommitStats();
+
+    LogInfo("Last commit: {:.3f} ms, {:.3f} ms under lock, {} flats assigned, {} flats inserted, {} flats total.",
+            commitStats.commitTime, commitStats.lockTime, commitStats.assignedFlats, commitStats.insertedFlats,
+            commitStats.totalFlats);
+
+    for (const auto& typeStats : m_manager->CollectBufferTypeStats())
+    {
+        LogInfo("{}: {} values, {} KiB | added {} values, {} KiB | pool {} values, {:.2f} load factor.",
+                typeStats.typeName.ToString(), typeStats.values, typeStats.bytes / 1024,
+                typeStats.addedValues, typeStats.addedBytes / 1024,
+                typeStats.poolValues, typeStats.poolLoadFactor);
+    }
+}
+
 void App::TweakService::CreateTweaksDir()
 {
     std::error_code error;
@@ -164,6 +344,26 @@ bool App::TweakService::RegisterDirectory(std::filesystem::path aPath)
     return true;
 }
 
+void App::TweakService::WarmUpReflection()
+{
+    const auto startTimePoint = std::chrono::steady_clock::now();
+    const auto recordCount = m_reflection->WarmUp();
+    const auto endTimePoint = std::chrono::steady_clock::now();
+
+    LogInfo("Resolved {} record types in {:.3f} ms.", recordCount,
+            std::chrono::duration<float, std::milli>(endTimePoint - startTimePoint).count());
+}
+
+void App::TweakService::BuildReferenceIndex()
+{
+    const auto startTimePoint = std::chrono::steady_clock::now();
+    const auto referenceCount = m_manager->BuildReferenceIndex();
+    const auto endTimePoint = std::chrono::steady_clock::now();
+
+    LogInfo("Indexed {} flat references in {:.3f} ms.", referenceCount,
+            std::chrono::duration<float, std::milli>(endTimePoint - startTimePoint).count());
+}
+
 bool App::TweakService::ImportMetadata()
 {
     MetadataImporter importer{m_manager};
@@ -176,6 +376,12 @@ bool App::TweakService::ImportMetadata()
         return false;
     }
 
+    m_reflection->BuildInheritanceMap();
+
+    const auto inheritanceStats = m_reflection->GetInheritanceStats();
+    LogInfo("Inheritance map has {} base records and {} descendants ({} KiB).", inheritanceStats.baseRecords,
+            inheritanceStats.descendants, inheritanceStats.size / 1024);
+
     LogInfo("Loading extra flats metadata...");
 
     if (!importer.ImportExtraFlats(m_extraFlatsPath))
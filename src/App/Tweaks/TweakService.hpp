@@ -21,16 +21,22 @@ class TweakService
 public:
     TweakService(const Core::SemvVer& aProductVer, std::filesystem::path aGameDir, std::filesystem::path aTweaksDir,
                  std::filesystem::path aInheritanceMapPath, std::filesystem::path aExtraFlatsPath,
-                 std::filesystem::path aSourcesDir);
+                 std::filesystem::path aSourcesDir, std::filesystem::path aCacheDir);
 
     bool RegisterTweak(std::filesystem::path aPath);
     bool RegisterDirectory(std::filesystem::path aPath);
 
     void LoadTweaks(bool aCheckForIssues);
+    void LoadChangedTweaks(bool aCheckForIssues);
     void ImportTweaks();
     void ExecuteTweaks();
     void ExecuteTweak(Red::CName aName);
     void CheckForIssues();
+    // Compaction moves the flat values, so it's only allowed while the database is loaded,
+    // before the game initializes it and starts reading the values. Later calls are refused.
+    void CompactBuffer(size_t aMinGarbageSize = 0);
+    void DumpBufferStats();
+    bool CompileBundle(std::filesystem::path aSourcePath, std::filesystem::path aBundlePath);
 
     bool ImportMetadata();
     void ExportMetadata();
@@ -44,10 +50,14 @@ protected:
     void CreateTweaksDir();
     void EnsureRuntimeAccess();
     void ApplyPatches();
+    void WarmUpReflection();
+    void BuildReferenceIndex();
+    bool IsImportPath(const std::filesystem::path& aPath);
 
     std::filesystem::path m_gameDir;
     std::filesystem::path m_tweaksDir;
     std::filesystem::path m_sourcesDir;
+    std::filesystem::path m_cacheDir;
     std::filesystem::path m_inheritanceMapPath;
     std::filesystem::path m_extraFlatsPath;
     const Core::SemvVer& m_productVer;
@@ -58,5 +68,6 @@ protected:
     Core::SharedPtr<App::TweakImporter> m_importer;
     Core::SharedPtr<App::TweakExecutor> m_executor;
     Core::SharedPtr<App::TweakContext> m_context;
+    bool m_isDatabaseLive;
 };
 }
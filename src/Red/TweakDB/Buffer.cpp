@@ -1,39 +1,122 @@
 #include "Buffer.hpp"
 #include "Reflection.hpp"
+#include "Core/Facades/Runtime.hpp"
+#include "Core/Hashing/FastHash.hpp"
+#include "Core/Memory/MappedFile.hpp"
+#include "Core/Threading/Parallel.hpp"
 
 namespace
 {
 constexpr auto FlatVFTSize = 8u;
 constexpr auto FlatAlignment = 8u;
+constexpr auto MinValuesPerShard = 16384u;
 
-const std::array<Red::CName, 26> s_flatTypes = {
-    Red::ERTDBFlatType::Int,
-    Red::ERTDBFlatType::Float,
-    Red::ERTDBFlatType::Bool,
-    Red::ERTDBFlatType::String,
-    Red::ERTDBFlatType::CName,
-    Red::ERTDBFlatType::TweakDBID,
-    Red::ERTDBFlatType::LocKey,
-    Red::ERTDBFlatType::ResRef,
-    Red::ERTDBFlatType::Quaternion,
-    Red::ERTDBFlatType::EulerAngles,
-    Red::ERTDBFlatType::Vector3,
-    Red::ERTDBFlatType::Vector2,
-    Red::ERTDBFlatType::Color,
-    Red::ERTDBFlatType::IntArray,
-    Red::ERTDBFlatType::FloatArray,
-    Red::ERTDBFlatType::BoolArray,
-    Red::ERTDBFlatType::StringArray,
-    Red::ERTDBFlatType::CNameArray,
-    Red::ERTDBFlatType::TweakDBIDArray,
-    Red::ERTDBFlatType::LocKeyArray,
-    Red::ERTDBFlatType::ResRefArray,
-    Red::ERTDBFlatType::QuaternionArray,
-    Red::ERTDBFlatType::EulerAnglesArray,
-    Red::ERTDBFlatType::Vector3Array,
-    Red::ERTDBFlatType::Vector2Array,
-    Red::ERTDBFlatType::ColorArray,
+// The snapshot stores value hashes, so the version must change with ComputeHash()
+constexpr uint32_t SnapshotMagic = 0x504C5854; // TXLP
+constexpr uint32_t SnapshotVersion = 2;
+constexpr size_t SnapshotSampleCount = 1024;
+constexpr size_t SnapshotSampleSize = 64;
+
+struct SnapshotHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t imageStamp;
+    uint64_t ownerVersion; // the values are pooled by hashes that can change between plugin versions
+    uint32_t hashVersion;
+    uint32_t padding;
+    uint64_t offsetEnd;
+    uint64_t fingerprint;
+    uint32_t typeCount;
+    uint32_t valueCount;
 };
+
+struct SnapshotType
+{
+    uint64_t vft; // relative to the image base
+    uint64_t typeName;
+    uint64_t offset;
+};
+
+struct SnapshotValue
+{
+    uint64_t typeName;
+    uint64_t hash;
+    int32_t offset;
+    uint32_t padding;
+};
+
+const IMAGE_NT_HEADERS* GetImageHeaders()
+{
+    const auto imageBase = Core::Runtime::GetImageBase();
+    const auto* dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER*>(imageBase);
+
+    return reinterpret_cast<const IMAGE_NT_HEADERS*>(imageBase + dosHeader->e_lfanew);
+}
+
+// Identifies the exact game executable, since VFT addresses depend on it.
+uint64_t GetImageStamp()
+{
+    const auto* ntHeaders = GetImageHeaders();
+
+    return (static_cast<uint64_t>(ntHeaders->FileHeader.TimeDateStamp) << 32)
+           | ntHeaders->OptionalHeader.SizeOfImage;
+}
+
+template<typename Hasher>
+uint64_t HashValue(const Red::CBaseRTTIType* aType, Red::Instance aInstance, uint32_t aSize, uint64_t aSeed,
+                   Hasher&& aHasher)
+{
+    // Case 1: Everything is processed as a sequence of bytes and passed to the hash function,
+    //         except for an array of strings.
+    // Case 2: Arrays of strings are different because of empty strings that don't produce any
+    //         hashing value. Therefore hash will be equal for different arrays in cases like:
+    //         [] == [""] == ["", ""]
+    //         ["", "a", "b"] == ["a", "", "b"] == ["a", "b", ""]
+    //         As a workaround, we hash the string length as part of the data.
+
+    uint64_t hash;
+
+    if (aType->GetType() == Red::ERTTIType::Array)
+    {
+        auto* arrayType = reinterpret_cast<const Red::CRTTIArrayType*>(aType);
+        auto* innerType = arrayType->GetInnerType();
+
+        if (innerType->GetName() == "String")
+        {
+            const auto* array = reinterpret_cast<Red::DynArray<Red::CString>*>(aInstance);
+            const auto size = aSize ? aSize : array->size;
+
+            hash = aSeed;
+            for (uint32_t i = 0; i != size; ++i)
+            {
+                const auto* str = array->entries + i;
+                const auto length = str->Length();
+                hash = aHasher(reinterpret_cast<const uint8_t*>(&length), sizeof(length), hash);
+                hash = aHasher(reinterpret_cast<const uint8_t*>(str->c_str()), length, hash);
+            }
+        }
+        else
+        {
+            const auto* array = reinterpret_cast<Red::DynArray<uint8_t>*>(aInstance);
+            const auto size = aSize ? aSize : array->size;
+            hash = aHasher(array->entries, size * innerType->GetSize(), aSeed);
+        }
+    }
+    else if (aType->GetName() == "String")
+    {
+        const auto* str = reinterpret_cast<Red::CString*>(aInstance);
+        const auto* data = reinterpret_cast<const uint8_t*>(str->c_str());
+        hash = aHasher(data, str->Length(), aSeed);
+    }
+    else
+    {
+        const auto* data = reinterpret_cast<const uint8_t*>(aInstance);
+        hash = aHasher(data, aType->GetSize(), aSeed);
+    }
+
+    return hash;
+}
 }
 
 Red::TweakDBBuffer::TweakDBBuffer()
@@ -45,6 +128,10 @@ Red::TweakDBBuffer::TweakDBBuffer(Red::TweakDB* aTweakDb)
     : m_tweakDb(aTweakDb)
     , m_bufferEnd(0)
     , m_offsetEnd(0)
+    , m_baseEnd(0)
+    , m_snapshotVersion(0)
+    , m_allocations(0)
+    , m_allocationHits(0)
 {
 }
 
@@ -58,27 +145,103 @@ int32_t Red::TweakDBBuffer::AllocateValue(const Red::CBaseRTTIType* aType, Red::
     if (m_bufferEnd != m_tweakDb->flatDataBufferEnd)
         SyncBufferData();
 
-    auto& pool = m_pools.at(aType->GetName());
+    auto& pool = *m_pools.at(aType->GetName());
     const auto hash = ComputeHash(aType, aInstance);
+    const auto isSame = [&](int32_t aOffset) {
+        return IsSameValue(aOffset, aType, aInstance);
+    };
+
+    std::shared_lock poolLockR(m_poolMutex);
 
+    ++m_allocations;
+
+    auto offset = pool.Find(hash, isSame);
+    if (offset != InvalidOffset)
     {
-        std::shared_lock poolLockR(m_poolMutex);
-        const auto offsetIt = pool.find(hash);
-        if (offsetIt != pool.end())
-            return offsetIt->second;
+        ++m_allocationHits;
+        return offset;
     }
 
-    const auto offset = m_tweakDb->CreateFlatValue({const_cast<Red::CBaseRTTIType*>(aType), aInstance});
-    // const auto copy = Red::MakeValue(const_cast<Red::CBaseRTTIType*>(aType), aInstance);
-    // const auto offset = m_tweakDb->CreateFlatValue(*copy);
+    auto isCreated = false;
+
+    offset = pool.FindOrCreate(hash, isSame, [&]() {
+        isCreated = true;
+        return AppendValue(aType, aInstance);
+    });
+
+    if (!isCreated)
+        ++m_allocationHits;
+
+    return offset;
+}
+
+Core::Vector<int32_t> Red::TweakDBBuffer::AllocateValues(std::span<const Red::Value<>> aValues)
+{
+    Core::Vector<int32_t> offsets(aValues.size(), InvalidOffset);
+
+    if (aValues.empty())
+        return offsets;
+
+    if (m_bufferEnd != m_tweakDb->flatDataBufferEnd)
+        SyncBufferData();
+
+    Core::Vector<uint64_t> hashes(aValues.size());
 
-    if (offset > 0)
     {
-        std::unique_lock poolLockRW(m_poolMutex);
-        pool.emplace(hash, offset);
+        const auto shardCount = std::max<size_t>(Core::GetWorkerCount(aValues.size() / MinValuesPerShard), 1);
+        const auto shardSize = (aValues.size() + shardCount - 1) / shardCount;
+
+        Core::ParallelFor(shardCount, [&](size_t aShard) {
+            const auto begin = aShard * shardSize;
+            const auto end = std::min(begin + shardSize, aValues.size());
+
+            for (auto i = begin; i < end; ++i)
+            {
+                hashes[i] = ComputeHash(aValues[i].type, aValues[i].instance);
+            }
+        });
     }
 
-    return offset;
+    std::shared_lock poolLockR(m_poolMutex);
+
+    Core::Vector<size_t> misses;
+
+    for (size_t i = 0; i < aValues.size(); ++i)
+    {
+        const auto& value = aValues[i];
+        const auto& pool = *m_pools.at(value.type->GetName());
+
+        offsets[i] = pool.Find(hashes[i], [&](int32_t aOffset) {
+            return IsSameValue(aOffset, value.type, value.instance);
+        });
+
+        if (offsets[i] == InvalidOffset)
+        {
+            misses.push_back(i);
+        }
+    }
+
+    // Equal values within the batch are appended only once,
+    // since the following ones find the value pooled by the first one.
+    size_t createdCount = 0;
+
+    for (const auto i : misses)
+    {
+        const auto& value = aValues[i];
+        auto& pool = *m_pools.at(value.type->GetName());
+
+        offsets[i] = pool.FindOrCreate(hashes[i], [&](int32_t aOffset) {
+            return IsSameValue(aOffset, value.type, value.instance);
+        }, [&]() {
+            ++createdCount;
+            return AppendValue(value.type, value.instance);
+        });
+    }
+
+    m_allocations += aValues.size();
+    m_allocationHits += aValues.size() - createdCount;
+
+    return offsets;
 }
 
 int32_t Red::TweakDBBuffer::AllocateDefault(const Red::CBaseRTTIType* aType)
@@ -100,6 +263,39 @@ Red::Value<> Red::TweakDBBuffer::GetValue(int32_t aOffset)
     return ResolveOffset(aOffset);
 }
 
+Red::Value<> Red::TweakDBBuffer::ReadValue(int32_t aOffset)
+{
+    if (aOffset < 0)
+        return {};
+
+    return ResolveOffset(aOffset);
+}
+
+void Red::TweakDBBuffer::Sync()
+{
+    if (m_bufferEnd != m_tweakDb->flatDataBufferEnd)
+        SyncBufferData();
+}
+
+Red::Value<> Red::TweakDBBuffer::GetValue(int32_t aOffset, const Red::CBaseRTTIType* aType)
+{
+    // The expected type is only trusted when the VFT at the offset is known to belong to it,
+    // otherwise the value is resolved as usual and has the actual type of the flat
+    if (aOffset < 0)
+        return {};
+
+    if (m_bufferEnd != m_tweakDb->flatDataBufferEnd)
+        SyncBufferData();
+
+    const auto addr = m_tweakDb->flatDataBuffer + aOffset;
+    const auto* typeInfo = m_types.Find(*reinterpret_cast<uintptr_t*>(addr));
+
+    if (!typeInfo || typeInfo->type != aType)
+        return ResolveOffset(aOffset);
+
+    return { typeInfo->type, reinterpret_cast<void*>(addr + typeInfo->offset) };
+}
+
 Red::Instance Red::TweakDBBuffer::GetValuePtr(int32_t aOffset)
 {
     if (aOffset < 0)
@@ -127,55 +323,24 @@ uint64_t Red::TweakDBBuffer::GetValueHash(int32_t aOffset)
 uint64_t Red::TweakDBBuffer::ComputeHash(const Red::CBaseRTTIType* aType, Red::Instance aInstance, uint32_t aSize,
                                          uint64_t aSeed)
 {
-    // Case 1: Everything is processed as a sequence of bytes and passed to the hash function,
-    //         except for an array of strings.
-    // Case 2: Arrays of strings are different because of empty strings that don't produce any
-    //         hashing value. Therefore hash will be equal for different arrays in cases like:
-    //         [] == [""] == ["", ""]
-    //         ["", "a", "b"] == ["a", "", "b"] == ["a", "b", ""]
-    //         As a workaround, we hash the string length as part of the data.
-
-    uint64_t hash;
-
-    if (aType->GetType() == Red::ERTTIType::Array)
-    {
-        auto* arrayType = reinterpret_cast<const Red::CRTTIArrayType*>(aType);
-        auto* innerType = arrayType->GetInnerType();
+    return HashValue(aType, aInstance, aSize, aSeed, [](const uint8_t* aData, size_t aLength, uint64_t aHash) {
+        return Core::FastHash64(aData, aLength, aHash);
+    });
+}
 
-        if (innerType->GetName() == "String")
-        {
-            const auto* array = reinterpret_cast<Red::DynArray<Red::CString>*>(aInstance);
-            const auto size = aSize ? aSize : array->size;
+bool Red::TweakDBBuffer::IsSameValue(int32_t aOffset, const Red::CBaseRTTIType* aType, Red::Instance aInstance)
+{
+    // A matching hash doesn't guarantee equal values,
+    // and a colliding value must get its own buffer entry.
+    const auto data = ResolveOffset(aOffset);
 
-            hash = aSeed;
-            for (uint32_t i = 0; i != size; ++i)
-            {
-                const auto* str = array->entries + i;
-                const auto length = str->Length();
-                hash = FNV1a64(reinterpret_cast<const uint8_t*>(&length), sizeof(length), hash);
-                hash = FNV1a64(reinterpret_cast<const uint8_t*>(str->c_str()), length, hash);
-            }
-        }
-        else
-        {
-            const auto* array = reinterpret_cast<Red::DynArray<uint8_t>*>(aInstance);
-            const auto size = aSize ? aSize : array->size;
-            hash = FNV1a64(array->entries, size * innerType->GetSize(), aSeed);
-        }
-    }
-    else if (aType->GetName() == "String")
-    {
-        const auto* str = reinterpret_cast<Red::CString*>(aInstance);
-        const auto* data = reinterpret_cast<const uint8_t*>(str->c_str());
-        hash = FNV1a64(data, str->Length(), aSeed);
-    }
-    else
-    {
-        const auto* data = reinterpret_cast<const uint8_t*>(aInstance);
-        hash = FNV1a64(data, aType->GetSize(), aSeed);
-    }
+    return data.type == aType && data.type->IsEqual(data.instance, aInstance);
+}
 
-    return hash;
+int32_t Red::TweakDBBuffer::AppendValue(const Red::CBaseRTTIType* aType, Red::Instance aInstance)
+{
+    std::lock_guard appendLock(m_appendMutex);
+    return m_tweakDb->CreateFlatValue({const_cast<Red::CBaseRTTIType*>(aType), aInstance});
 }
 
 Red::Value<> Red::TweakDBBuffer::ResolveOffset(int32_t aOffset)
@@ -185,20 +350,20 @@ Red::Value<> Red::TweakDBBuffer::ResolveOffset(int32_t aOffset)
 
     const auto addr = m_tweakDb->flatDataBuffer + aOffset;
     const auto vft = *reinterpret_cast<uintptr_t*>(addr);
-    const auto it = m_types.find(vft);
+    const auto* typeInfo = m_types.Find(vft);
 
     // For a known VFT we can immediately get RTTI type and data pointer.
-    if (it != m_types.end())
-        return { it->second.type, reinterpret_cast<void*>(addr + it->second.offset) };
+    if (typeInfo)
+        return { typeInfo->type, reinterpret_cast<void*>(addr + typeInfo->offset) };
 
     // For an unknown VFT, we call the virtual GetValue() once to get the type.
     const auto data = reinterpret_cast<TweakDBFlatValue*>(addr)->GetValue();
 
-    // Add type info to the map.
+    // Add type info to the table.
     // In addition to the RTTI type, we also store the data offset considering alignment.
     // Quaternion is 16-byte aligned, so there is 8-byte padding between the VFT and the data:
     // [ 8B VFT ][ 8B PAD ][ 16B QUATERNION ]
-    m_types.insert({ vft, { data.type, std::max(data.type->GetAlignment(), FlatAlignment) } });
+    m_types.Insert(vft, { data.type, std::max(data.type->GetAlignment(), FlatAlignment) });
 
     return data;
 }
@@ -211,7 +376,7 @@ void Red::TweakDBBuffer::CreatePools()
 
         for (const auto& typeName : s_flatTypes)
         {
-            m_pools.emplace(typeName, 0);
+            m_pools.emplace(typeName, Core::MakeUnique<TweakDBFlatPool>());
         }
     }
 }
@@ -222,23 +387,16 @@ void Red::TweakDBBuffer::FillDefaults()
     {
         for (const auto& typeName : s_flatTypes)
         {
-            auto& pool = m_pools.at(typeName);
+            auto& pool = *m_pools.at(typeName);
 
             const auto value = Red::MakeValue(typeName);
             const auto hash = ComputeHash(value->type, value->instance);
-            const auto it = pool.find(hash);
 
-            int32_t offset = -1;
-
-            if (it != pool.end())
-            {
-                offset = it->second;
-            }
-            else
-            {
-                offset = m_tweakDb->CreateFlatValue(*value);
-                pool.emplace(hash, offset);
-            }
+            const auto offset = pool.FindOrCreate(hash, [&](int32_t aOffset) {
+                return IsSameValue(aOffset, value->type, value->instance);
+            }, [&]() {
+                return m_tweakDb->CreateFlatValue(*value);
+            });
 
             m_defaults.emplace(typeName, offset);
 
@@ -259,14 +417,27 @@ void Red::TweakDBBuffer::SyncBufferData()
         return;
     }
 
-    if (m_offsetEnd == 0)
+    const auto isInitialSync = m_offsetEnd == 0;
+    const auto startTimePoint = std::chrono::steady_clock::now();
+
+    if (isInitialSync)
+    {
         CreatePools();
 
-    const auto startTimePoint = std::chrono::steady_clock::now();
+        // Only the values added after the snapshot was made have to be scanned
+        if (LoadSnapshot())
+        {
+            m_stats.snapshotSize = m_offsetEnd;
+        }
+    }
 
     {
         std::shared_lock flatLockR(m_tweakDb->mutex00);
 
+        // Value boundaries can only be found sequentially, since the size of each value depends on its type,
+        // so the values are collected first and then hashed in parallel.
+        Core::Vector<ScannedValue> values;
+
         auto offset = Red::AlignUp(static_cast<uint32_t>(m_offsetEnd), FlatAlignment);
         while (offset < offsetEnd)
         {
@@ -277,32 +448,85 @@ void Red::TweakDBBuffer::SyncBufferData()
                  offset += 8u;
 
             const auto data = ResolveOffset(static_cast<int32_t>(offset));
-            const auto hash = ComputeHash(data.type, data.instance);
-
-            auto& pool = m_pools.at(data.type->GetName());
-
-            // Check for duplicates...
-            // (Original game's blob has ~24K duplicates)
-            if (!pool.contains(hash))
-                pool.emplace(hash, offset);
+            values.push_back({static_cast<int32_t>(offset), data});
 
             // Step {vft + data_size} aligned by {max(data_align, 8)}
             offset += Red::AlignUp(FlatVFTSize + data.type->GetSize(),
                                    std::max(FlatAlignment, data.type->GetAlignment()));
         }
+
+        PoolValues(values);
     }
 
     const auto endTimePoint = std::chrono::steady_clock::now();
     const auto updateTime = std::chrono::duration_cast<std::chrono::duration<float>>(endTimePoint - startTimePoint).count();
 
-    if (m_offsetEnd == 0)
+    if (isInitialSync)
+    {
+        if (m_offsetEnd == 0)
+            SaveSnapshot(offsetEnd);
+
+        // Values beyond this point are the only ones that can be compacted
+        m_baseEnd = offsetEnd;
+
         FillDefaults();
+    }
 
     SyncBufferBounds();
 
     UpdateStats(updateTime);
 }
 
+void Red::TweakDBBuffer::PoolValues(const Core::Vector<ScannedValue>& aValues)
+{
+    // Check for duplicates...
+    // (Original game's blob has ~24K duplicates)
+    // Only the first offset of equal values is pooled, which emplace() guarantees.
+
+    const auto shardCount = Core::GetWorkerCount(aValues.size() / MinValuesPerShard);
+
+    if (shardCount <= 1)
+    {
+        for (const auto& value : aValues)
+        {
+            auto& pool = *m_pools.at(value.data.type->GetName());
+            pool.Insert(ComputeHash(value.data.type, value.data.instance), value.offset);
+        }
+        return;
+    }
+
+    const auto shardSize = (aValues.size() + shardCount - 1) / shardCount;
+    Core::Vector<Core::Map<Red::CName, FlatValueMap>> shards(shardCount);
+
+    Core::ParallelFor(shardCount, [&](size_t aShard) {
+        auto& shard = shards[aShard];
+        const auto begin = aShard * shardSize;
+        const auto end = std::min(begin + shardSize, aValues.size());
+
+        for (auto i = begin; i < end; ++i)
+        {
+            const auto& value = aValues[i];
+            shard[value.data.type->GetName()].emplace(ComputeHash(value.data.type, value.data.instance),
+                                                      value.offset);
+        }
+    });
+
+    // Shards cover consecutive ranges of the buffer,
+    // so merging them in order keeps the first offset of equal values.
+    for (const auto& shard : shards)
+    {
+        for (const auto& [typeName, shardPool] : shard)
+        {
+            auto& pool = *m_pools.at(typeName);
+
+            for (const auto& [hash, offset] : shardPool)
+            {
+                pool.Insert(hash, offset);
+            }
+        }
+    }
+}
+
 void Red::TweakDBBuffer::SyncBufferBounds()
 {
     m_bufferEnd = m_tweakDb->flatDataBufferEnd;
@@ -321,11 +545,18 @@ void Red::TweakDBBuffer::UpdateStats(float updateTime)
 
     size_t totalValues = 0;
     for (const auto& pool : m_pools)
-        totalValues += pool.second.size();
+        totalValues += pool.second->GetSize();
+
+    size_t totalBuckets = 0;
+    for (const auto& pool : m_pools)
+        totalBuckets += pool.second->GetBucketCount();
 
     m_stats.poolSize = m_offsetEnd;
     m_stats.poolValues = totalValues;
-    m_stats.knownTypes = m_types.size();
+    m_stats.poolLoadFactor = totalBuckets ? static_cast<float>(totalValues) / static_cast<float>(totalBuckets) : 0;
+    m_stats.baseSize = m_baseEnd;
+    m_stats.addedSize = m_offsetEnd > m_baseEnd ? m_offsetEnd - m_baseEnd : 0;
+    m_stats.knownTypes = m_types.GetSize();
     m_stats.flatEntries = m_tweakDb->flats.size;
 
 #ifdef VERBOSE
@@ -337,9 +568,456 @@ void Red::TweakDBBuffer::UpdateStats(float updateTime)
 #endif
 }
 
+void Red::TweakDBBuffer::SetSnapshotPath(std::filesystem::path aPath, uint64_t aVersion)
+{
+    m_snapshotPath = std::move(aPath);
+    m_snapshotVersion = aVersion;
+}
+
+bool Red::TweakDBBuffer::LoadSnapshot()
+{
+    if (m_snapshotPath.empty())
+        return false;
+
+    Core::MappedFile file;
+    if (!file.Open(m_snapshotPath) || file.GetSize() < sizeof(SnapshotHeader))
+        return false;
+
+    const auto* header = reinterpret_cast<const SnapshotHeader*>(file.GetData());
+
+    if (header->magic != SnapshotMagic || header->version != SnapshotVersion)
+        return false;
+
+    if (header->ownerVersion != m_snapshotVersion || header->hashVersion != Core::FastHashVersion)
+        return false;
+
+    const auto expectedSize = sizeof(SnapshotHeader) + header->typeCount * sizeof(SnapshotType)
+                              + header->valueCount * sizeof(SnapshotValue);
+
+    if (file.GetSize() != expectedSize)
+        return false;
+
+    if (header->imageStamp != GetImageStamp())
+        return false;
+
+    // The snapshot is still valid if the game's blob was only extended since it was made
+    if (header->offsetEnd > m_tweakDb->flatDataBufferEnd - m_tweakDb->flatDataBuffer)
+        return false;
+
+    const auto* types = reinterpret_cast<const SnapshotType*>(header + 1);
+    const auto* values = reinterpret_cast<const SnapshotValue*>(types + header->typeCount);
+
+    const auto imageBase = Core::Runtime::GetImageBase();
+    auto* rtti = Red::CRTTISystem::Get();
+
+    Core::Vector<std::pair<uintptr_t, FlatTypeInfo>> snapshotTypes;
+    Core::Map<uintptr_t, uint64_t> snapshotTypeNames;
+
+    for (uint32_t i = 0; i < header->typeCount; ++i)
+    {
+        auto* type = rtti->GetType(Red::CName(types[i].typeName));
+
+        if (!type || !m_pools.contains(type->GetName()))
+            return false;
+
+        snapshotTypes.push_back({imageBase + types[i].vft, {type, static_cast<uintptr_t>(types[i].offset)}});
+        snapshotTypeNames.emplace(imageBase + types[i].vft, types[i].typeName);
+    }
+
+    for (uint32_t i = 0; i < header->valueCount; ++i)
+    {
+        if (!m_pools.contains(Red::CName(values[i].typeName)))
+            return false;
+    }
+
+    {
+        std::shared_lock flatLockR(m_tweakDb->mutex00);
+
+        if (header->fingerprint != ComputeFingerprint(header->offsetEnd))
+            return false;
+
+        // The fingerprint only samples the buffer, so every restored offset must also point
+        // to a flat of the type it was pooled for before the offset is trusted
+        for (uint32_t i = 0; i < header->valueCount; ++i)
+        {
+            const auto offset = values[i].offset;
+
+            if (offset < 0 || offset % FlatAlignment != 0 || offset + FlatVFTSize > header->offsetEnd)
+                return false;
+
+            const auto vft = *reinterpret_cast<uintptr_t*>(m_tweakDb->flatDataBuffer + offset);
+            const auto it = snapshotTypeNames.find(vft);
+
+            if (it == snapshotTypeNames.end() || it->second != values[i].typeName)
+                return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < header->valueCount; ++i)
+    {
+        m_pools.at(Red::CName(values[i].typeName))->Insert(values[i].hash, values[i].offset);
+    }
+
+    // The types resolved so far are the same in the snapshot, so the table is only extended
+    for (const auto& [vft, typeInfo] : snapshotTypes)
+    {
+        m_types.Insert(vft, typeInfo);
+    }
+
+    m_offsetEnd = header->offsetEnd;
+
+    return true;
+}
+
+void Red::TweakDBBuffer::SaveSnapshot(uintptr_t aOffsetEnd)
+{
+    if (m_snapshotPath.empty())
+        return;
+
+    SnapshotHeader header{};
+    header.magic = SnapshotMagic;
+    header.version = SnapshotVersion;
+    header.imageStamp = GetImageStamp();
+    header.ownerVersion = m_snapshotVersion;
+    header.hashVersion = Core::FastHashVersion;
+    header.offsetEnd = aOffsetEnd;
+
+    {
+        std::shared_lock flatLockR(m_tweakDb->mutex00);
+        header.fingerprint = ComputeFingerprint(aOffsetEnd);
+    }
+
+    const auto imageBase = Core::Runtime::GetImageBase();
+
+    Core::Vector<SnapshotType> types;
+    types.reserve(m_types.GetSize());
+
+    m_types.ForEach([&types, imageBase](uintptr_t aVFT, const FlatTypeInfo& aTypeInfo) {
+        types.push_back({aVFT - imageBase, aTypeInfo.type->GetName().hash, aTypeInfo.offset});
+    });
+
+    Core::Vector<SnapshotValue> values;
+
+    for (const auto& pool : m_pools)
+    {
+        const auto typeName = pool.first.hash;
+
+        pool.second->ForEach([&values, typeName](uint64_t aHash, int32_t aOffset) {
+            values.push_back({typeName, aHash, aOffset, 0});
+        });
+    }
+
+    header.typeCount = static_cast<uint32_t>(types.size());
+    header.valueCount = static_cast<uint32_t>(values.size());
+
+    std::error_code error;
+    std::filesystem::create_directories(m_snapshotPath.parent_path(), error);
+
+    auto tempPath = m_snapshotPath;
+    tempPath += L".tmp";
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(types.data()),
+                   static_cast<std::streamsize>(types.size() * sizeof(SnapshotType)));
+        file.write(reinterpret_cast<const char*>(values.data()),
+                   static_cast<std::streamsize>(values.size() * sizeof(SnapshotValue)));
+
+        if (!file)
+            return;
+    }
+
+    std::filesystem::rename(tempPath, m_snapshotPath, error);
+}
+
+uint64_t Red::TweakDBBuffer::ComputeFingerprint(uintptr_t aOffsetEnd)
+{
+    // Samples evenly spaced parts of the buffer instead of hashing the whole buffer.
+    // Every flat starts with a VFT pointer that changes with the image base,
+    // so pointers into the game image are made relative before hashing.
+    const auto imageBase = Core::Runtime::GetImageBase();
+    const auto imageEnd = imageBase + GetImageHeaders()->OptionalHeader.SizeOfImage;
+    const auto alignMask = ~static_cast<uintptr_t>(FlatAlignment - 1);
+    const auto step = std::max<uintptr_t>((aOffsetEnd / SnapshotSampleCount) & alignMask, SnapshotSampleSize);
+
+    auto fingerprint = Core::FastHash64(&aOffsetEnd, sizeof(aOffsetEnd));
+
+    const auto hashSample = [&](uintptr_t aOffset) {
+        uint64_t sample[SnapshotSampleSize / sizeof(uint64_t)];
+        std::memcpy(sample, reinterpret_cast<const void*>(m_tweakDb->flatDataBuffer + aOffset), sizeof(sample));
+
+        for (auto& qword : sample)
+        {
+            if (qword >= imageBase && qword < imageEnd)
+                qword -= imageBase;
+        }
+
+        fingerprint = Core::FastHash64(sample, sizeof(sample), fingerprint);
+    };
+
+    if (aOffsetEnd >= SnapshotSampleSize)
+    {
+        for (uintptr_t offset = 0; offset + SnapshotSampleSize <= aOffsetEnd; offset += step)
+        {
+            hashSample(offset);
+        }
+
+        hashSample((aOffsetEnd - SnapshotSampleSize) & alignMask);
+    }
+
+    return fingerprint;
+}
+
+Red::TweakDBBuffer::CompactionResult Red::TweakDBBuffer::Compact(std::span<int32_t*> aOffsetRefs,
+                                                                  std::span<Red::Instance*> aInstanceRefs,
+                                                                  size_t aMinGarbageSize)
+{
+    if (m_bufferEnd != m_tweakDb->flatDataBufferEnd)
+        SyncBufferData();
+
+    CompactionResult result{};
+
+    {
+        std::unique_lock poolLockRW(m_poolMutex);
+        std::unique_lock flatLockRW(m_tweakDb->mutex00);
+
+        if (m_baseEnd == 0)
+            return result;
+
+        const auto startTimePoint = std::chrono::steady_clock::now();
+
+        const auto buffer = m_tweakDb->flatDataBuffer;
+        const auto offsetBegin = static_cast<int32_t>(Red::AlignUp(static_cast<uint32_t>(m_baseEnd), FlatAlignment));
+        const auto offsetEnd = static_cast<int32_t>(m_tweakDb->flatDataBufferEnd - buffer);
+
+        // Values can be referenced either by the offset of the flat or by the pointer to the data.
+        // Everything below the base end belongs to the game's blob and is always kept.
+        Core::Set<int32_t> liveOffsets;
+        Core::Set<uintptr_t> liveData;
+
+        for (auto* flat = m_tweakDb->flats.Begin(); flat != m_tweakDb->flats.End(); ++flat)
+        {
+            if (flat->ToTDBOffset() >= offsetBegin)
+                liveOffsets.insert(flat->ToTDBOffset());
+        }
+
+        for (const auto& [_, offset] : m_defaults)
+        {
+            if (offset >= offsetBegin)
+                liveOffsets.insert(offset);
+        }
+
+        for (const auto* ref : aOffsetRefs)
+        {
+            if (*ref >= offsetBegin)
+                liveOffsets.insert(*ref);
+        }
+
+        for (const auto* ref : aInstanceRefs)
+        {
+            liveData.insert(reinterpret_cast<uintptr_t>(*ref));
+        }
+
+        struct ValueBlock
+        {
+            int32_t offset;
+            uint32_t size;
+            Red::Value<> data;
+            bool isLive;
+        };
+
+        Core::Vector<ValueBlock> blocks;
+
+        auto offset = offsetBegin;
+        while (offset < offsetEnd)
+        {
+            if (*reinterpret_cast<uint64_t*>(buffer + offset) == 0ull)
+                offset += 8;
+
+            const auto data = ResolveOffset(offset);
+            const auto size = Red::AlignUp(FlatVFTSize + data.type->GetSize(),
+                                           std::max(FlatAlignment, data.type->GetAlignment()));
+            const auto isLive = liveOffsets.contains(offset)
+                                || liveData.contains(reinterpret_cast<uintptr_t>(data.instance));
+
+            if (!isLive)
+                result.garbageSize += size;
+
+            blocks.push_back({offset, size, data, isLive});
+
+            offset += static_cast<int32_t>(size);
+        }
+
+        if (result.garbageSize == 0 || result.garbageSize < aMinGarbageSize)
+            return result;
+
+        // Values are only moved towards the beginning and processed in order,
+        // so a value is never overwritten before it's visited.
+        Core::Map<int32_t, int32_t> movedOffsets;
+        Core::Map<uintptr_t, uintptr_t> movedData;
+
+        auto cursor = offsetBegin;
+        for (const auto& block : blocks)
+        {
+            if (!block.isLive)
+            {
+                block.data.type->Destruct(block.data.instance);
+                ++result.releasedValues;
+                continue;
+            }
+
+            // 16-byte aligned values are preceded by an 8-byte zero padding
+            const auto alignment = std::max(FlatAlignment, block.data.type->GetAlignment());
+            const auto alignMask = ~static_cast<uintptr_t>(alignment - 1);
+            const auto target = static_cast<int32_t>(((buffer + cursor + alignment - 1) & alignMask) - buffer);
+
+            if (target != cursor)
+                std::memset(reinterpret_cast<void*>(buffer + cursor), 0, target - cursor);
+
+            if (target != block.offset)
+            {
+                std::memmove(reinterpret_cast<void*>(buffer + target), reinterpret_cast<void*>(buffer + block.offset),
+                             block.size);
+
+                const auto dataAddr = reinterpret_cast<uintptr_t>(block.data.instance);
+                if (liveData.contains(dataAddr))
+                    movedData.emplace(dataAddr, dataAddr - block.offset + target);
+
+                movedOffsets.emplace(block.offset, target);
+                ++result.movedValues;
+            }
+
+            cursor = target + static_cast<int32_t>(block.size);
+        }
+
+        std::memset(reinterpret_cast<void*>(buffer + cursor), 0, offsetEnd - cursor);
+        m_tweakDb->flatDataBufferEnd = buffer + cursor;
+
+        const auto relocate = [&movedOffsets](int32_t& aOffset) {
+            const auto it = movedOffsets.find(aOffset);
+            if (it != movedOffsets.end())
+                aOffset = it->second;
+        };
+
+        for (auto* flat = m_tweakDb->flats.Begin(); flat != m_tweakDb->flats.End(); ++flat)
+        {
+            const auto it = movedOffsets.find(flat->ToTDBOffset());
+            if (it != movedOffsets.end())
+                flat->SetTDBOffset(it->second);
+        }
+
+        for (auto it = m_defaults.begin(); it != m_defaults.end(); ++it)
+        {
+            relocate(it.value());
+        }
+
+        for (auto* ref : aOffsetRefs)
+        {
+            relocate(*ref);
+        }
+
+        for (auto* ref : aInstanceRefs)
+        {
+            const auto it = movedData.find(reinterpret_cast<uintptr_t>(*ref));
+            if (it != movedData.end())
+                *ref = reinterpret_cast<Red::Instance>(it->second);
+        }
+
+        // Pooled values of the compacted range are rescanned on the next sync
+        for (const auto& typeName : s_flatTypes)
+        {
+            m_pools.at(typeName)->EraseFrom(offsetBegin);
+        }
+
+        m_bufferEnd = 0;
+        m_offsetEnd = m_baseEnd;
+
+        const auto endTimePoint = std::chrono::steady_clock::now();
+
+        result.compactionTime = std::chrono::duration<float, std::milli>(endTimePoint - startTimePoint).count();
+        result.reclaimedSize = offsetEnd - cursor;
+    }
+
+    SyncBufferData();
+
+    return result;
+}
+
 Red::TweakDBBuffer::BufferStats Red::TweakDBBuffer::GetStats() const
 {
-    return m_stats;
+    auto stats = m_stats;
+    stats.allocations = m_allocations;
+    stats.allocationHits = m_allocationHits;
+
+    return stats;
+}
+
+Core::Vector<Red::TweakDBBuffer::TypeStats> Red::TweakDBBuffer::CollectTypeStats()
+{
+    if (m_bufferEnd != m_tweakDb->flatDataBufferEnd)
+        SyncBufferData();
+
+    Core::Map<Red::CName, TypeStats> typeStats;
+
+    {
+        std::shared_lock poolLockR(m_poolMutex);
+        std::shared_lock flatLockR(m_tweakDb->mutex00);
+
+        // The totals are not tracked during the scan, because the snapshot skips most of the buffer
+        const auto offsetEnd = m_tweakDb->flatDataBufferEnd - m_tweakDb->flatDataBuffer;
+
+        uint32_t offset = 0;
+        while (offset < offsetEnd)
+        {
+            if (*reinterpret_cast<uint64_t*>(m_tweakDb->flatDataBuffer + offset) == 0ull)
+                offset += 8u;
+
+            const auto data = ResolveOffset(static_cast<int32_t>(offset));
+            const auto size = Red::AlignUp(FlatVFTSize + data.type->GetSize(),
+                                           std::max(FlatAlignment, data.type->GetAlignment()));
+
+            auto& stats = typeStats[data.type->GetName()];
+            ++stats.values;
+            stats.bytes += size;
+
+            if (offset >= m_baseEnd)
+            {
+                ++stats.addedValues;
+                stats.addedBytes += size;
+            }
+
+            offset += size;
+        }
+
+        for (const auto& [typeName, pool] : m_pools)
+        {
+            const auto poolValues = pool->GetSize();
+            const auto poolBuckets = pool->GetBucketCount();
+
+            auto& stats = typeStats[typeName];
+            stats.poolValues = poolValues;
+            stats.poolLoadFactor = poolBuckets ? static_cast<float>(poolValues) / static_cast<float>(poolBuckets) : 0;
+        }
+    }
+
+    Core::Vector<TypeStats> result;
+    result.reserve(typeStats.size());
+
+    for (auto it = typeStats.begin(); it != typeStats.end(); ++it)
+    {
+        it.value().typeName = it->first;
+        result.push_back(it.value());
+    }
+
+    std::sort(result.begin(), result.end(), [](const TypeStats& aLeft, const TypeStats& aRight) {
+        return aLeft.bytes > aRight.bytes;
+    });
+
+    return result;
 }
 
 void Red::TweakDBBuffer::Invalidate()
@@ -348,10 +1026,11 @@ void Red::TweakDBBuffer::Invalidate()
 
     m_bufferEnd = 0;
     m_offsetEnd = 0;
+    m_baseEnd = 0;
 
     for (const auto& typeName : s_flatTypes)
     {
-        m_pools.at(typeName).clear();
+        m_pools.at(typeName)->Clear();
     }
 
     m_stats = {};
@@ -1,13 +1,15 @@
 #pragma once
 
 #include "Red/TweakDB/Alias.hpp"
+#include "Red/TweakDB/FlatPool.hpp"
+#include "Red/TweakDB/FlatTypeTable.hpp"
 
 namespace Red
 {
 class TweakDBBuffer
 {
 public:
-    static constexpr int32_t InvalidOffset = -1;
+    static constexpr int32_t InvalidOffset = TweakDBFlatPool::InvalidOffset;
 
     struct BufferStats
     {
@@ -17,6 +19,32 @@ public:
         size_t poolValues = 0;
         size_t knownTypes = 0;
         size_t flatEntries = 0;
+        size_t snapshotSize = 0; // bytes of the buffer restored from the snapshot
+        size_t baseSize = 0; // bytes of the buffer at the initial sync
+        size_t addedSize = 0; // bytes appended since the initial sync
+        size_t allocations = 0; // values requested through AllocateValue()
+        size_t allocationHits = 0; // requested values found in the pools
+        float poolLoadFactor = 0.0;
+    };
+
+    struct TypeStats
+    {
+        Red::CName typeName;
+        size_t values = 0;
+        size_t bytes = 0;
+        size_t addedValues = 0; // values appended since the initial sync
+        size_t addedBytes = 0;
+        size_t poolValues = 0;
+        float poolLoadFactor = 0.0;
+    };
+
+    struct CompactionResult
+    {
+        float compactionTime = 0.0; // ms
+        size_t garbageSize = 0; // bytes
+        size_t reclaimedSize = 0; // bytes
+        size_t movedValues = 0;
+        size_t releasedValues = 0;
     };
 
     TweakDBBuffer();
@@ -25,12 +53,32 @@ public:
     int32_t AllocateValue(const Red::Value<>& aData);
     int32_t AllocateValue(const Red::CBaseRTTIType* aType, Red::Instance aInstance);
     int32_t AllocateDefault(const Red::CBaseRTTIType* aType);
+    Core::Vector<int32_t> AllocateValues(std::span<const Red::Value<>> aValues);
 
     Red::Value<> GetValue(int32_t aOffset);
+    Red::Value<> GetValue(int32_t aOffset, const Red::CBaseRTTIType* aType);
     Red::Instance GetValuePtr(int32_t aOffset);
     uint64_t GetValueHash(int32_t aOffset);
 
+    // Brings the buffer state up to date with the TweakDB if new values were added.
+    void Sync();
+
+    // Same as GetValue, but doesn't sync the buffer state, so it can be used from multiple threads
+    // at once. The caller must call Sync beforehand and make sure the buffer isn't modified meanwhile.
+    Red::Value<> ReadValue(int32_t aOffset);
+
     [[nodiscard]] BufferStats GetStats() const;
+    Core::Vector<TypeStats> CollectTypeStats();
+
+    // The snapshot is only loaded if it was saved with the same version.
+    void SetSnapshotPath(std::filesystem::path aPath, uint64_t aVersion);
+
+    // Releases the values appended after the initial sync that are no longer referenced
+    // and moves the remaining ones to close the gaps. Besides the flats and the type defaults,
+    // values can be kept alive by the given offsets and data pointers, which are updated in place.
+    // Nothing is done if there is less garbage than the given threshold.
+    CompactionResult Compact(std::span<int32_t*> aOffsetRefs, std::span<Red::Instance*> aInstanceRefs,
+                             size_t aMinGarbageSize = 0);
 
     void Invalidate();
 
@@ -44,26 +92,44 @@ private:
         uintptr_t offset;
     };
 
+    struct ScannedValue
+    {
+        int32_t offset;
+        Red::Value<> data;
+    };
+
     using FlatValueMap = Core::Map<uint64_t, int32_t>; // ValueHash -> BufferOffset
-    using FlatPoolMap = Core::Map<Red::CName, FlatValueMap>; // TypeName -> FlatPool
+    using FlatTypeTable = TweakDBFlatTypeTable<FlatTypeInfo>; // VFT -> FlatTypeInfo
+    using FlatPoolMap = Core::Map<Red::CName, Core::UniquePtr<TweakDBFlatPool>>; // TypeName -> FlatPool
     using FlatDefaultMap = Core::Map<Red::CName, int32_t>; // TypeName -> BufferOffset
-    using FlatTypeMap = Core::Map<uintptr_t, FlatTypeInfo>; // VFT -> FlatTypeInfo
 
     inline Red::Value<> ResolveOffset(int32_t aOffset);
+    inline bool IsSameValue(int32_t aOffset, const Red::CBaseRTTIType* aType, Red::Instance aInstance);
+    inline int32_t AppendValue(const Red::CBaseRTTIType* aType, Red::Instance aInstance);
 
     void CreatePools();
     void FillDefaults();
     void SyncBufferData();
+    void PoolValues(const Core::Vector<ScannedValue>& aValues);
     void SyncBufferBounds();
     void UpdateStats(float updateTime = 0);
+    bool LoadSnapshot();
+    void SaveSnapshot(uintptr_t aOffsetEnd);
+    uint64_t ComputeFingerprint(uintptr_t aOffsetEnd);
 
     Red::TweakDB* m_tweakDb;
     FlatPoolMap m_pools;
     FlatDefaultMap m_defaults;
-    FlatTypeMap m_types;
+    FlatTypeTable m_types;
     uintptr_t m_bufferEnd;
     uintptr_t m_offsetEnd;
+    uintptr_t m_baseEnd;
     BufferStats m_stats;
+    std::filesystem::path m_snapshotPath;
+    uint64_t m_snapshotVersion;
+    std::atomic<size_t> m_allocations;
+    std::atomic<size_t> m_allocationHits;
     std::shared_mutex m_poolMutex;
+    std::mutex m_appendMutex;
 };
 }
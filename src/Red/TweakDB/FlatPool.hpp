@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Core/Stl.hpp"
+
+#include <array>
+#include <mutex>
+#include <shared_mutex>
+
+namespace Red
+{
+// Value pool of a single flat type, split into independently locked shards by the value hash.
+// Looking up or creating a value only locks the shard of its hash, so equal values are always
+// resolved under the same lock and get the same offset.
+class TweakDBFlatPool
+{
+public:
+    static constexpr int32_t InvalidOffset = -1;
+
+    template<typename Predicate>
+    int32_t Find(uint64_t aHash, Predicate&& aIsSame) const
+    {
+        const auto& shard = GetShard(aHash);
+        std::shared_lock shardLockR(shard.mutex);
+
+        const auto it = shard.values.find(aHash);
+        if (it != shard.values.end() && aIsSame(it->second))
+            return it->second;
+
+        return InvalidOffset;
+    }
+
+    // A different value with the same hash is created, but not pooled.
+    template<typename Predicate, typename Factory>
+    int32_t FindOrCreate(uint64_t aHash, Predicate&& aIsSame, Factory&& aCreate)
+    {
+        auto& shard = GetShard(aHash);
+        std::unique_lock shardLockRW(shard.mutex);
+
+        const auto it = shard.values.find(aHash);
+        if (it != shard.values.end())
+            return aIsSame(it->second) ? it->second : aCreate();
+
+        const auto offset = aCreate();
+
+        if (offset > 0)
+            shard.values.emplace(aHash, offset);
+
+        return offset;
+    }
+
+    // Keeps the existing offset if the hash is already pooled.
+    void Insert(uint64_t aHash, int32_t aOffset)
+    {
+        auto& shard = GetShard(aHash);
+        std::unique_lock shardLockRW(shard.mutex);
+        shard.values.emplace(aHash, aOffset);
+    }
+
+    template<typename Callback>
+    void ForEach(Callback&& aCallback) const
+    {
+        for (const auto& shard : m_shards)
+        {
+            std::shared_lock shardLockR(shard.mutex);
+            for (const auto& [hash, offset] : shard.values)
+            {
+                aCallback(hash, offset);
+            }
+        }
+    }
+
+    [[nodiscard]] size_t GetBucketCount() const
+    {
+        size_t count = 0;
+        for (const auto& shard : m_shards)
+        {
+            std::shared_lock shardLockR(shard.mutex);
+            count += shard.values.bucket_count();
+        }
+        return count;
+    }
+
+    [[nodiscard]] size_t GetSize() const
+    {
+        size_t size = 0;
+        for (const auto& shard : m_shards)
+        {
+            std::shared_lock shardLockR(shard.mutex);
+            size += shard.values.size();
+        }
+        return size;
+    }
+
+    // Removes the values that will be pooled again after the rescan.
+    void EraseFrom(int32_t aOffset)
+    {
+        for (auto& shard : m_shards)
+        {
+            std::unique_lock shardLockRW(shard.mutex);
+            for (auto it = shard.values.begin(); it != shard.values.end();)
+            {
+                if (it->second >= aOffset)
+                    it = shard.values.erase(it);
+                else
+                    ++it;
+            }
+        }
+    }
+
+    void Clear()
+    {
+        for (auto& shard : m_shards)
+        {
+            std::unique_lock shardLockRW(shard.mutex);
+            shard.values.clear();
+        }
+    }
+
+private:
+    using ValueMap = Core::Map<uint64_t, int32_t>; // ValueHash -> BufferOffset
+
+    static constexpr size_t ShardBits = 4;
+
+    struct Shard
+    {
+        ValueMap values;
+        mutable std::shared_mutex mutex;
+    };
+
+    Shard& GetShard(uint64_t aHash)
+    {
+        return m_shards[aHash >> (64 - ShardBits)];
+    }
+
+    const Shard& GetShard(uint64_t aHash) const
+    {
+        return m_shards[aHash >> (64 - ShardBits)];
+    }
+
+    std::array<Shard, 1 << ShardBits> m_shards;
+};
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace Red
+{
+// Fixed capacity table of flat types indexed by VFT, using linear probing.
+// There are only a few dozen flat types, so the table always stays sparse.
+// Slots are published atomically and never removed while in use, so lookups don't need a lock.
+template<typename T>
+class TweakDBFlatTypeTable
+{
+public:
+    const T* Find(uintptr_t aVFT) const
+    {
+        auto index = GetIndex(aVFT);
+        for (size_t i = 0; i < Capacity; ++i, index = (index + 1) & (Capacity - 1))
+        {
+            const auto& slot = m_slots[index];
+            const auto vft = slot.vft.load(std::memory_order_acquire);
+
+            if (vft == aVFT)
+                return &slot.info;
+
+            if (vft == 0)
+                break;
+        }
+        return nullptr;
+    }
+
+    // Returns false if the table is full, one slot is always kept empty to stop probing.
+    bool Insert(uintptr_t aVFT, const T& aInfo)
+    {
+        std::lock_guard lock(m_mutex);
+
+        auto index = GetIndex(aVFT);
+        for (size_t i = 0; i < Capacity; ++i, index = (index + 1) & (Capacity - 1))
+        {
+            auto& slot = m_slots[index];
+            const auto vft = slot.vft.load(std::memory_order_relaxed);
+
+            if (vft == aVFT)
+                return true;
+
+            if (vft == 0)
+            {
+                if (m_size + 1 >= Capacity)
+                    return false;
+
+                slot.info = aInfo;
+                slot.vft.store(aVFT, std::memory_order_release);
+                ++m_size;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template<typename Callback>
+    void ForEach(Callback&& aCallback) const
+    {
+        for (const auto& slot : m_slots)
+        {
+            const auto vft = slot.vft.load(std::memory_order_acquire);
+            if (vft != 0)
+            {
+                aCallback(vft, slot.info);
+            }
+        }
+    }
+
+    [[nodiscard]] size_t GetSize() const
+    {
+        return m_size;
+    }
+
+private:
+    static constexpr size_t CapacityBits = 6;
+    static constexpr size_t Capacity = 1 << CapacityBits;
+
+    struct Slot
+    {
+        std::atomic<uintptr_t> vft{0};
+        T info{};
+    };
+
+    static size_t GetIndex(uintptr_t aVFT)
+    {
+        return static_cast<size_t>(((aVFT >> 3) * 0x9E3779B97F4A7C15ull) >> (64 - CapacityBits));
+    }
+
+    std::array<Slot, Capacity> m_slots;
+    std::atomic<size_t> m_size{0};
+    std::mutex m_mutex;
+};
+}
@@ -1,11 +1,8 @@
 #include "Manager.hpp"
+#include "Core/Threading/Parallel.hpp"
+#include "Core/Tracing/Tracer.hpp"
 #include "Red/TweakDB/Raws.hpp"
 
-namespace
-{
-constexpr auto OptimizedFlatChunkSize = 16000;
-}
-
 Red::TweakDBManager::TweakDBManager()
     : TweakDBManager(Red::TweakDB::Get())
 {
@@ -15,6 +12,8 @@ Red::TweakDBManager::TweakDBManager(Red::TweakDB* aTweakDb)
     : m_tweakDb(aTweakDb)
     , m_buffer(Core::MakeShared<Red::TweakDBBuffer>(m_tweakDb))
     , m_reflection(Core::MakeShared<Red::TweakDBReflection>(m_tweakDb))
+    , m_referencesBuilt(false)
+    , m_openBatches(0)
 {
 }
 
@@ -22,6 +21,8 @@ Red::TweakDBManager::TweakDBManager(Core::SharedPtr<Red::TweakDBReflection> aRef
     : m_tweakDb(aReflection->GetTweakDB())
     , m_buffer(Core::MakeShared<Red::TweakDBBuffer>(m_tweakDb))
     , m_reflection(std::move(aReflection))
+    , m_referencesBuilt(false)
+    , m_openBatches(0)
 {
 }
 
@@ -42,6 +43,23 @@ Red::Value<> Red::TweakDBManager::GetFlat(Red::TweakDBID aFlatId)
     return m_buffer->GetValue(offset);
 }
 
+Red::Value<> Red::TweakDBManager::GetFlat(Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType)
+{
+    int32_t offset;
+
+    {
+        std::shared_lock flatLockR(m_tweakDb->mutex00);
+        auto* flat = m_tweakDb->flats.Find(aFlatId);
+
+        if (flat == m_tweakDb->flats.End())
+            return {};
+
+        offset = flat->ToTDBOffset();
+    }
+
+    return m_buffer->GetValue(offset, aType);
+}
+
 Red::Value<> Red::TweakDBManager::GetDefault(const Red::CBaseRTTIType* aType)
 {
     if (!m_reflection->IsFlatType(aType))
@@ -80,12 +98,49 @@ bool Red::TweakDBManager::IsRecordExists(Red::TweakDBID aRecordId)
     return m_tweakDb->recordsByID.Get(aRecordId) != nullptr;
 }
 
+Core::Vector<Red::TweakDBID> Red::TweakDBManager::FindMissing(Core::Vector<Red::TweakDBID> aIds)
+{
+    std::sort(aIds.begin(), aIds.end());
+    aIds.erase(std::unique(aIds.begin(), aIds.end()), aIds.end());
+
+    // Both locks are held for the whole pass, always in this order, so the records and flats are checked
+    // against the same state of the database
+    std::shared_lock flatLockR(m_tweakDb->mutex00);
+    std::shared_lock recordLockR(m_tweakDb->mutex01);
+
+    // Both sequences are sorted, so every flat search continues from the previous match
+    const auto* flat = m_tweakDb->flats.Begin();
+    const auto* flatsEnd = m_tweakDb->flats.End();
+
+    std::erase_if(aIds, [&](Red::TweakDBID aId) {
+        flat = std::lower_bound(flat, flatsEnd, aId);
+
+        if (flat != flatsEnd && !(aId < *flat))
+            return true;
+
+        return m_tweakDb->recordsByID.Get(aId) != nullptr;
+    });
+
+    return aIds;
+}
+
 bool Red::TweakDBManager::SetFlat(Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType, Red::Instance aInstance)
 {
     if (!aFlatId.IsValid() || !aInstance || !m_reflection->IsFlatType(aType))
         return false;
 
-    return AssignFlat(m_tweakDb->flats, aFlatId, aType, aInstance, m_tweakDb->mutex00);
+    if (!IsReferenceType(aType) || !m_referencesBuilt.load(std::memory_order_acquire))
+        return AssignFlat(m_tweakDb->flats, aFlatId, aType, aInstance, m_tweakDb->mutex00);
+
+    const auto previousValue = GetFlat(aFlatId);
+
+    if (!AssignFlat(m_tweakDb->flats, aFlatId, aType, aInstance, m_tweakDb->mutex00))
+        return false;
+
+    std::unique_lock referenceLockRW(m_referenceMutex);
+    ReplaceReferences(aFlatId, previousValue, {aType, aInstance});
+
+    return true;
 }
 
 bool Red::TweakDBManager::SetFlat(Red::TweakDBID aFlatId, const Red::Value<>& aData)
@@ -107,6 +162,8 @@ bool Red::TweakDBManager::CreateRecord(Red::TweakDBID aRecordId, const Red::CCla
     propFlats.Reserve(recordInfo->props.size());
     InheritFlats(propFlats, aRecordId, recordInfo);
 
+    UpdateReferences({propFlats.Begin(), propFlats.End()});
+
     {
         std::unique_lock flatLockRW(m_tweakDb->mutex00);
         m_tweakDb->flats.Insert(propFlats);
@@ -135,6 +192,8 @@ bool Red::TweakDBManager::CloneRecord(Red::TweakDBID aRecordId, Red::TweakDBID a
     propFlats.Reserve(recordInfo->props.size());
     InheritFlats(propFlats, aRecordId, recordInfo, aSourceId);
 
+    UpdateReferences({propFlats.Begin(), propFlats.End()});
+
     {
         std::unique_lock flatLockRW(m_tweakDb->mutex00);
         m_tweakDb->flats.Insert(propFlats);
@@ -168,6 +227,8 @@ bool Red::TweakDBManager::InheritProps(Red::TweakDBID aRecordId, Red::TweakDBID
     propFlats.Reserve(recordInfo->props.size());
     InheritFlats(propFlats, aRecordId, recordInfo, aSourceId);
 
+    UpdateReferences({propFlats.Begin(), propFlats.End()});
+
     {
         std::unique_lock flatLockRW(m_tweakDb->mutex00);
         m_tweakDb->flats.Insert(propFlats);
@@ -178,6 +239,8 @@ bool Red::TweakDBManager::InheritProps(Red::TweakDBID aRecordId, Red::TweakDBID
 
 bool Red::TweakDBManager::UpdateRecord(Red::TweakDBID aRecordId)
 {
+    Core::TraceScope trace("tweakdb", "UpdateRecord");
+
     if (!aRecordId.IsValid())
         return false;
 
@@ -207,9 +270,22 @@ void Red::TweakDBManager::RegisterName(Red::TweakDBID aId, const std::string& aN
     CreateExtraNames(aId, aName, aType);
 }
 
+Red::TweakDBManager::Batch::~Batch()
+{
+    if (openCounter)
+    {
+        openCounter->fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
 Red::TweakDBManager::BatchPtr Red::TweakDBManager::StartBatch()
 {
-    return Core::MakeShared<Batch>();
+    auto batch = Core::MakeShared<Batch>();
+    batch->openCounter = &m_openBatches;
+
+    m_openBatches.fetch_add(1, std::memory_order_acq_rel);
+
+    return batch;
 }
 
 const Core::Set<Red::TweakDBID>& Red::TweakDBManager::GetFlats(const Red::TweakDBManager::BatchPtr& aBatch)
@@ -280,6 +356,77 @@ bool Red::TweakDBManager::SetFlat(const Red::TweakDBManager::BatchPtr& aBatch, R
     return AssignFlat(aBatch, aFlatId, aValue);
 }
 
+Core::Vector<Red::TweakDBID> Red::TweakDBManager::SetFlats(const Red::TweakDBManager::BatchPtr& aBatch,
+                                                       std::span<const Red::TweakDBID> aFlatIds,
+                                                       std::span<const Red::Value<>> aValues)
+{
+    Core::Vector<Red::TweakDBID> failedFlats;
+    Core::Vector<Red::TweakDBID> pendingFlats;
+    Core::Vector<Red::Value<>> pendingValues;
+
+    std::unique_lock batchLockRW(aBatch->mutex);
+
+    for (size_t i = 0; i < aFlatIds.size(); ++i)
+    {
+        const auto& flatId = aFlatIds[i];
+        const auto& value = aValues[i];
+
+        if (!flatId.IsValid() || !value.instance || !m_reflection->IsFlatType(value.type))
+        {
+            failedFlats.push_back(flatId);
+            continue;
+        }
+
+        const auto& flat = aBatch->flats.find(flatId);
+
+        if (flat != aBatch->flats.end())
+        {
+            const auto current = m_buffer->GetValue(flat->ToTDBOffset());
+
+            if (current.type != value.type)
+            {
+                failedFlats.push_back(flatId);
+                continue;
+            }
+
+            if (current.type->IsEqual(current.instance, value.instance))
+                continue;
+        }
+
+        pendingFlats.push_back(flatId);
+        pendingValues.push_back(value);
+    }
+
+    // All new values are allocated at once to avoid locking the buffer for every flat
+    const auto offsets = m_buffer->AllocateValues(pendingValues);
+
+    for (size_t i = 0; i < pendingFlats.size(); ++i)
+    {
+        auto flatId = pendingFlats[i];
+
+        if (offsets[i] < 0)
+        {
+            failedFlats.push_back(flatId);
+            continue;
+        }
+
+        flatId.SetTDBOffset(offsets[i]);
+
+        const auto& flat = aBatch->flats.find(flatId);
+
+        if (flat != aBatch->flats.end())
+        {
+            const_cast<Red::TweakDBID&>(*flat) = flatId;
+        }
+        else
+        {
+            aBatch->flats.insert(flatId);
+        }
+    }
+
+    return failedFlats;
+}
+
 bool Red::TweakDBManager::CreateRecord(const Red::TweakDBManager::BatchPtr& aBatch, Red::TweakDBID aRecordId,
                                        const Red::CClass* aType)
 {
@@ -375,6 +522,10 @@ void Red::TweakDBManager::RegisterName(const Red::TweakDBManager::BatchPtr& aBat
 
 void Red::TweakDBManager::CommitBatch(const BatchPtr& aBatch)
 {
+    Core::TraceScope trace("tweakdb", "CommitBatch");
+
+    const auto startTimePoint = std::chrono::steady_clock::now();
+
     std::unique_lock batchLockRW(aBatch->mutex);
 
     for (const auto& [id, name] : aBatch->names)
@@ -382,27 +533,15 @@ void Red::TweakDBManager::CommitBatch(const BatchPtr& aBatch)
         CreateBaseName(id, name);
     }
 
+    if (m_referencesBuilt.load(std::memory_order_acquire))
     {
-        Red::SortedUniqueArray<Red::TweakDBID> flatsChunk;
+        const Core::Vector<Red::TweakDBID> batchFlats(aBatch->flats.begin(), aBatch->flats.end());
+        UpdateReferences(batchFlats);
+    }
 
-        for (const auto& flatId : aBatch->flats)
-        {
-            flatsChunk.InsertOrAssign(flatId);
+    CommitStats stats;
 
-            if (flatsChunk.size >= OptimizedFlatChunkSize)
-            {
-                std::unique_lock flatLockRW(m_tweakDb->mutex00);
-                m_tweakDb->flats.InsertOrAssign(flatsChunk);
-                flatsChunk.Clear();
-            }
-        }
-
-        if (flatsChunk.size > 0)
-        {
-            std::unique_lock flatLockRW(m_tweakDb->mutex00);
-            m_tweakDb->flats.InsertOrAssign(flatsChunk);
-        }
-    }
+    MergeFlats(aBatch->flats, stats);
 
     for (const auto& [recordId, recordInfo] : aBatch->records)
     {
@@ -427,6 +566,214 @@ void Red::TweakDBManager::CommitBatch(const BatchPtr& aBatch)
     aBatch->flats.clear();
     aBatch->records.clear();
     aBatch->names.clear();
+
+    const auto endTimePoint = std::chrono::steady_clock::now();
+
+    stats.commitTime = std::chrono::duration<float, std::milli>(endTimePoint - startTimePoint).count();
+
+    {
+        // Batches can be committed from different threads
+        std::unique_lock statsLock(m_commitStatsMutex);
+        m_commitStats = stats;
+    }
+}
+
+void Red::TweakDBManager::MergeFlats(const Core::Set<Red::TweakDBID>& aFlats, CommitStats& aStats)
+{
+    Core::TraceScope trace("tweakdb", "Merging flats");
+
+    Core::Vector<Red::TweakDBID> newFlats(aFlats.begin(), aFlats.end());
+    std::sort(newFlats.begin(), newFlats.end());
+
+    const auto lockTimePoint = std::chrono::steady_clock::now();
+
+    std::unique_lock flatLockRW(m_tweakDb->mutex00);
+
+    auto& flats = m_tweakDb->flats;
+
+    // Existing flats only get the new offset, leaving only new flats for the merge
+    auto newEnd = std::remove_if(newFlats.begin(), newFlats.end(), [&flats](Red::TweakDBID aFlatId) {
+        auto* flat = flats.Find(aFlatId);
+
+        if (flat == flats.End())
+            return false;
+
+        *flat = aFlatId;
+        return true;
+    });
+
+    const auto assignedCount = static_cast<uint32_t>(newFlats.end() - newEnd);
+    const auto insertedCount = static_cast<uint32_t>(newEnd - newFlats.begin());
+
+    if (insertedCount > 0)
+    {
+        const auto oldSize = flats.size;
+
+        flats.Reserve(oldSize + insertedCount);
+
+        // Merge from the back, so that every existing flat is moved only once
+        auto* entries = flats.Begin();
+        auto source = static_cast<int64_t>(oldSize) - 1;
+        auto target = static_cast<int64_t>(oldSize + insertedCount) - 1;
+        auto inserted = static_cast<int64_t>(insertedCount) - 1;
+
+        while (inserted >= 0)
+        {
+            if (source >= 0 && newFlats[inserted] < entries[source])
+            {
+                entries[target--] = entries[source--];
+            }
+            else
+            {
+                entries[target--] = newFlats[inserted--];
+            }
+        }
+
+        flats.size = oldSize + insertedCount;
+    }
+
+    const auto unlockTimePoint = std::chrono::steady_clock::now();
+
+    aStats.lockTime = std::chrono::duration<float, std::milli>(unlockTimePoint - lockTimePoint).count();
+    aStats.assignedFlats = assignedCount;
+    aStats.insertedFlats = insertedCount;
+    aStats.totalFlats = flats.size;
+}
+
+Red::TweakDBManager::CommitStats Red::TweakDBManager::GetCommitStats() const
+{
+    std::unique_lock statsLock(m_commitStatsMutex);
+    return m_commitStats;
+}
+
+bool Red::TweakDBManager::HasOpenBatches() const
+{
+    return m_openBatches.load(std::memory_order_acquire) > 0;
+}
+
+Red::TweakDBBuffer::BufferStats Red::TweakDBManager::GetBufferStats() const
+{
+    return m_buffer->GetStats();
+}
+
+Core::Vector<Red::TweakDBBuffer::TypeStats> Red::TweakDBManager::CollectBufferTypeStats()
+{
+    return m_buffer->CollectTypeStats();
+}
+
+Red::TweakDBBuffer::CompactionResult Red::TweakDBManager::CompactBuffer(std::span<Red::Instance*> aInstanceRefs,
+                                                                        size_t aMinGarbageSize)
+{
+    Core::TraceScope trace("tweakdb", "CompactBuffer");
+
+    if (HasOpenBatches())
+        return {};
+
+    auto defaultRefs = m_reflection->GetDefaultValueRefs();
+    auto result = m_buffer->Compact(defaultRefs, aInstanceRefs, aMinGarbageSize);
+
+    if (result.movedValues > 0)
+    {
+        // Records read the values through the flat offsets, which have been changed
+        auto* rtti = Red::CRTTISystem::Get();
+        auto* baseRecordType = rtti->GetClass(Red::GetTypeName<Red::TweakDBRecord>());
+
+        Red::DynArray<Red::CClass*> recordTypes;
+        rtti->GetClasses(baseRecordType, recordTypes);
+
+        std::unique_lock recordLockRW(m_tweakDb->mutex01);
+
+        for (auto* recordType : recordTypes)
+        {
+            const auto* records = m_tweakDb->recordsByType.Get(recordType);
+
+            if (!records)
+                continue;
+
+            for (const auto& record : *records)
+            {
+                m_tweakDb->UpdateRecord(*reinterpret_cast<const Red::Handle<Red::TweakDBRecord>*>(&record));
+            }
+        }
+    }
+
+    return result;
+}
+
+size_t Red::TweakDBManager::BuildReferenceIndex()
+{
+    Core::TraceScope trace("tweakdb", "BuildReferenceIndex");
+
+    // The workers read the buffer without syncing, so it must be up to date before they start
+    m_buffer->Sync();
+
+    Core::Vector<Red::TweakDBID> flats;
+
+    {
+        std::shared_lock flatLockR(m_tweakDb->mutex00);
+        flats.assign(m_tweakDb->flats.Begin(), m_tweakDb->flats.End());
+    }
+
+    // Every chunk collects its own (referenced ID, flat ID) pairs, which are merged in the original order
+    constexpr size_t ChunkSize = 16384;
+    const auto chunkCount = (flats.size() + ChunkSize - 1) / ChunkSize;
+
+    Core::Vector<Core::Vector<std::pair<Red::TweakDBID, Red::TweakDBID>>> chunks(chunkCount);
+
+    Core::ParallelFor(chunkCount, [&](size_t aIndex) {
+        const auto begin = aIndex * ChunkSize;
+        const auto end = std::min(begin + ChunkSize, flats.size());
+
+        Core::Vector<Red::TweakDBID> targets;
+
+        for (auto i = begin; i < end; ++i)
+        {
+            auto flatId = flats[i];
+            const auto value = m_buffer->ReadValue(flatId.ToTDBOffset());
+
+            targets.clear();
+            CollectReferences(value, targets);
+
+            flatId.SetTDBOffset(0);
+
+            for (const auto& targetId : targets)
+            {
+                chunks[aIndex].emplace_back(targetId, flatId);
+            }
+        }
+    });
+
+    size_t referenceCount = 0;
+
+    std::unique_lock referenceLockRW(m_referenceMutex);
+
+    m_references.clear();
+
+    for (const auto& chunk : chunks)
+    {
+        for (const auto& [targetId, flatId] : chunk)
+        {
+            m_references[targetId].push_back(flatId);
+        }
+
+        referenceCount += chunk.size();
+    }
+
+    m_referencesBuilt.store(true, std::memory_order_release);
+
+    return referenceCount;
+}
+
+Core::Vector<Red::TweakDBID> Red::TweakDBManager::GetReferences(Red::TweakDBID aTargetId)
+{
+    std::shared_lock referenceLockR(m_referenceMutex);
+
+    const auto it = m_references.find(aTargetId);
+
+    if (it == m_references.end())
+        return {};
+
+    return it->second;
 }
 
 void Red::TweakDBManager::Invalidate()
@@ -434,6 +781,11 @@ void Red::TweakDBManager::Invalidate()
     m_buffer->Invalidate();
 }
 
+void Red::TweakDBManager::SetBufferSnapshotPath(std::filesystem::path aPath, uint64_t aVersion)
+{
+    m_buffer->SetSnapshotPath(std::move(aPath), aVersion);
+}
+
 Red::TweakDB* Red::TweakDBManager::GetTweakDB()
 {
     return m_tweakDb;
@@ -697,3 +1049,138 @@ const Core::Set<Red::TweakDBID>& Red::TweakDBManager::GetEnums()
 
     return m_knownEnums;
 }
+
+bool Red::TweakDBManager::IsReferenceType(const Red::CBaseRTTIType* aType)
+{
+    return m_reflection->IsForeignKey(aType) || m_reflection->IsForeignKeyArray(aType);
+}
+
+void Red::TweakDBManager::CollectReferences(const Red::Value<>& aValue, Core::Vector<Red::TweakDBID>& aTargets)
+{
+    if (!aValue.instance)
+        return;
+
+    if (m_reflection->IsForeignKey(aValue.type))
+    {
+        const auto targetId = *reinterpret_cast<Red::TweakDBID*>(aValue.instance);
+
+        if (targetId.IsValid())
+        {
+            aTargets.push_back(targetId);
+        }
+    }
+    else if (m_reflection->IsForeignKeyArray(aValue.type))
+    {
+        const auto* targetIds = reinterpret_cast<Red::DynArray<Red::TweakDBID>*>(aValue.instance);
+
+        for (const auto& targetId : *targetIds)
+        {
+            if (targetId.IsValid())
+            {
+                aTargets.push_back(targetId);
+            }
+        }
+
+        // Lists may refer to the same record several times, but the flat is indexed once
+        std::ranges::sort(aTargets, {}, [](Red::TweakDBID aId) { return aId.value; });
+        aTargets.erase(std::unique(aTargets.begin(), aTargets.end()), aTargets.end());
+    }
+}
+
+void Red::TweakDBManager::ReplaceReferences(Red::TweakDBID aFlatId, const Red::Value<>& aPreviousValue,
+                                            const Red::Value<>& aValue)
+{
+    Core::Vector<Red::TweakDBID> previousTargets;
+    Core::Vector<Red::TweakDBID> targets;
+
+    CollectReferences(aPreviousValue, previousTargets);
+    CollectReferences(aValue, targets);
+
+    aFlatId.SetTDBOffset(0);
+
+    for (const auto& targetId : previousTargets)
+    {
+        if (std::ranges::find(targets, targetId) != targets.end())
+            continue;
+
+        auto it = m_references.find(targetId);
+
+        if (it == m_references.end())
+            continue;
+
+        auto& flatIds = it.value();
+        auto flatIt = std::ranges::find(flatIds, aFlatId);
+
+        if (flatIt != flatIds.end())
+        {
+            *flatIt = flatIds.back();
+            flatIds.pop_back();
+        }
+
+        if (flatIds.empty())
+        {
+            m_references.erase(it);
+        }
+    }
+
+    for (const auto& targetId : targets)
+    {
+        if (std::ranges::find(previousTargets, targetId) != previousTargets.end())
+            continue;
+
+        m_references[targetId].push_back(aFlatId);
+    }
+}
+
+void Red::TweakDBManager::UpdateReferences(std::span<const Red::TweakDBID> aFlats)
+{
+    if (aFlats.empty() || !m_referencesBuilt.load(std::memory_order_acquire))
+        return;
+
+    // The flats carry the offsets of the new values, while the current offsets are still in the flat table
+    Core::Vector<std::pair<Red::TweakDBID, Red::Value<>>> changes;
+
+    for (const auto& flat : aFlats)
+    {
+        auto value = m_buffer->GetValue(flat.ToTDBOffset());
+
+        if (IsReferenceType(value.type))
+        {
+            changes.emplace_back(flat, value);
+        }
+    }
+
+    if (changes.empty())
+        return;
+
+    Core::Vector<int32_t> previousOffsets(changes.size(), -1);
+
+    {
+        std::shared_lock flatLockR(m_tweakDb->mutex00);
+
+        for (size_t i = 0; i < changes.size(); ++i)
+        {
+            const auto* flat = m_tweakDb->flats.Find(changes[i].first);
+
+            if (flat != m_tweakDb->flats.End())
+            {
+                previousOffsets[i] = flat->ToTDBOffset();
+            }
+        }
+    }
+
+    Core::Vector<Red::Value<>> previousValues;
+    previousValues.reserve(changes.size());
+
+    for (const auto& offset : previousOffsets)
+    {
+        previousValues.push_back(m_buffer->GetValue(offset));
+    }
+
+    std::unique_lock referenceLockRW(m_referenceMutex);
+
+    for (size_t i = 0; i < changes.size(); ++i)
+    {
+        ReplaceReferences(changes[i].first, previousValues[i], changes[i].second);
+    }
+}
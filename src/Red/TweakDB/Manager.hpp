@@ -11,15 +11,29 @@ class TweakDBManager
 public:
     class Batch
     {
+    public:
+        ~Batch();
+
+    private:
         Core::Set<Red::TweakDBID> flats;
         Core::Map<Red::TweakDBID, const Red::TweakDBRecordInfo*> records;
         Core::Map<Red::TweakDBID, const std::string> names;
         std::shared_mutex mutex;
+        std::atomic<uint32_t>* openCounter{nullptr};
         friend TweakDBManager;
     };
 
     using BatchPtr = Core::SharedPtr<Batch>;
 
+    struct CommitStats
+    {
+        float commitTime = 0.0; // ms
+        float lockTime = 0.0; // ms
+        size_t assignedFlats = 0;
+        size_t insertedFlats = 0;
+        size_t totalFlats = 0;
+    };
+
     TweakDBManager();
     explicit TweakDBManager(Red::TweakDB* aTweakDb);
     explicit TweakDBManager(Core::SharedPtr<Red::TweakDBReflection> aReflection);
@@ -28,11 +42,13 @@ public:
     TweakDBManager& operator=(const TweakDBManager&) = delete;
 
     Red::Value<> GetFlat(Red::TweakDBID aFlatId);
+    Red::Value<> GetFlat(Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType);
     Red::Value<> GetDefault(const Red::CBaseRTTIType* aType);
     Red::Handle<Red::TweakDBRecord> GetRecord(Red::TweakDBID aRecordId);
     const Red::CClass* GetRecordType(Red::TweakDBID aRecordId);
     bool IsFlatExists(Red::TweakDBID aFlatId);
     bool IsRecordExists(Red::TweakDBID aRecordId);
+    Core::Vector<Red::TweakDBID> FindMissing(Core::Vector<Red::TweakDBID> aIds);
     bool SetFlat(Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType, Red::Instance aInstance);
     bool SetFlat(Red::TweakDBID aFlatId, const Red::Value<>& aData);
     bool CreateRecord(Red::TweakDBID aRecordId, const Red::CClass* aType);
@@ -53,6 +69,8 @@ public:
     bool IsRecordExists(const BatchPtr& aBatch, Red::TweakDBID aRecordId);
     bool SetFlat(const BatchPtr& aBatch, Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType, Red::Instance aValue);
     bool SetFlat(const BatchPtr& aBatch, Red::TweakDBID aFlatId, const Red::Value<>& aData);
+    Core::Vector<Red::TweakDBID> SetFlats(const BatchPtr& aBatch, std::span<const Red::TweakDBID> aFlatIds,
+                                          std::span<const Red::Value<>> aValues);
     bool CreateRecord(const BatchPtr& aBatch, Red::TweakDBID aRecordId, const Red::CClass* aType);
     bool CloneRecord(const BatchPtr& aBatch, Red::TweakDBID aRecordId, Red::TweakDBID aSourceId);
     bool InheritProps(const BatchPtr& aBatch, Red::TweakDBID aRecordId, Red::TweakDBID aSourceId);
@@ -61,7 +79,24 @@ public:
     void RegisterName(const BatchPtr& aBatch, Red::TweakDBID aId, const std::string& aName);
     void CommitBatch(const BatchPtr& aBatch);
 
+    [[nodiscard]] CommitStats GetCommitStats() const;
+    [[nodiscard]] Red::TweakDBBuffer::BufferStats GetBufferStats() const;
+    Core::Vector<Red::TweakDBBuffer::TypeStats> CollectBufferTypeStats();
+
+    // Moving the values invalidates every pointer to them that isn't passed in the references,
+    // so it must only be called before the game initializes the database and starts reading the values.
+    // Batches keep the offsets of their values, so nothing is done while any batch is open.
+    Red::TweakDBBuffer::CompactionResult CompactBuffer(std::span<Red::Instance*> aInstanceRefs,
+                                                       size_t aMinGarbageSize = 0);
+    [[nodiscard]] bool HasOpenBatches() const;
+
+    // Reverse index of the TweakDBID and TweakDBID[] flats, mapping referenced IDs to the referring flats.
+    // It's built once from the current flats and then follows every flat change made through the manager.
+    size_t BuildReferenceIndex();
+    Core::Vector<Red::TweakDBID> GetReferences(Red::TweakDBID aTargetId);
+
     void Invalidate();
+    void SetBufferSnapshotPath(std::filesystem::path aPath, uint64_t aVersion);
 
     Red::TweakDB* GetTweakDB();
     Core::SharedPtr<Red::TweakDBReflection>& GetReflection();
@@ -83,6 +118,13 @@ private:
     inline void InheritFlats(const Red::TweakDBManager::BatchPtr& aBatch, Red::TweakDBID aRecordId,
                              const Red::TweakDBRecordInfo* aRecordInfo, Red::TweakDBID aSourceId);
 
+    void MergeFlats(const Core::Set<Red::TweakDBID>& aFlats, CommitStats& aStats);
+
+    bool IsReferenceType(const Red::CBaseRTTIType* aType);
+    void CollectReferences(const Red::Value<>& aValue, Core::Vector<Red::TweakDBID>& aTargets);
+    void ReplaceReferences(Red::TweakDBID aFlatId, const Red::Value<>& aPreviousValue, const Red::Value<>& aValue);
+    void UpdateReferences(std::span<const Red::TweakDBID> aFlats);
+
     void CreateBaseName(Red::TweakDBID aId, const std::string& aName);
     void CreateExtraNames(Red::TweakDBID aId, const std::string& aName, const Red::CClass* aType = nullptr);
 
@@ -91,6 +133,12 @@ private:
     Core::SharedPtr<Red::TweakDBReflection> m_reflection;
     Core::Map<Red::TweakDBID, std::string> m_knownNames;
     Core::Set<Red::TweakDBID> m_knownEnums;
+    CommitStats m_commitStats;
+    mutable std::mutex m_commitStatsMutex;
     std::shared_mutex m_mutex;
+    Core::Map<Red::TweakDBID, Core::Vector<Red::TweakDBID>> m_references;
+    std::atomic<bool> m_referencesBuilt;
+    std::atomic<uint32_t> m_openBatches;
+    std::shared_mutex m_referenceMutex;
 };
 }
@@ -1,4 +1,7 @@
 #include "Reflection.hpp"
+#include "Core/Facades/Runtime.hpp"
+#include "Core/Memory/Binary.hpp"
+#include "Core/Threading/Parallel.hpp"
 #include "Red/TweakDB/Source/Grammar.hpp"
 #include "Red/TweakDB/Source/Source.hpp"
 
@@ -20,6 +23,19 @@ constexpr auto ScriptResRefArrayTypeName = Red::GetTypeName<Red::DynArray<Red::R
 constexpr auto NameSeparator = Red::TweakGrammar::Name::Separator;
 constexpr auto PropSeparator = std::string_view(NameSeparator);
 constexpr auto DataOffsetSize = 12;
+
+uint64_t GetGameVersion()
+{
+    const auto& fileVer = Core::Runtime::GetHost()->GetFileVer();
+
+    return (static_cast<uint64_t>(fileVer.major) << 48) | (static_cast<uint64_t>(fileVer.minor) << 32)
+           | (static_cast<uint64_t>(fileVer.build) << 16) | fileVer.revision;
+}
+
+uint64_t GetTypeHash(const Red::CBaseRTTIType* aType)
+{
+    return aType ? aType->GetName().hash : 0;
+}
 }
 
 Red::TweakDBReflection::TweakDBReflection()
@@ -30,6 +46,8 @@ Red::TweakDBReflection::TweakDBReflection()
 Red::TweakDBReflection::TweakDBReflection(Red::TweakDB* aTweakDb)
     : m_tweakDb(aTweakDb)
     , m_rtti(Red::CRTTISystem::Get())
+    , m_isWarmedUp(false)
+    , m_cachedRecords(0)
 {
 }
 
@@ -38,26 +56,104 @@ const Red::TweakDBRecordInfo* Red::TweakDBReflection::GetRecordInfo(const Red::C
     if (!IsRecordType(aType))
         return nullptr;
 
-    {
-        std::shared_lock lockR(m_mutex);
-        auto iter = m_resolved.find(aType->GetName());
-        if (iter != m_resolved.end())
-            return iter->second.get();
-    }
+    if (const auto recordInfo = FindRecordInfo(aType->GetName()))
+        return recordInfo.get();
 
     return CollectRecordInfo(aType).get();
 }
 
 const Red::TweakDBRecordInfo* Red::TweakDBReflection::GetRecordInfo(Red::CName aTypeName)
 {
+    if (const auto recordInfo = FindRecordInfo(aTypeName))
+        return recordInfo.get();
+
+    return CollectRecordInfo(m_rtti->GetClass(aTypeName)).get();
+}
+
+Core::SharedPtr<Red::TweakDBRecordInfo> Red::TweakDBReflection::FindRecordInfo(Red::CName aTypeName)
+{
+    // The warmed up table is never modified after it's published
+    if (m_isWarmedUp.load(std::memory_order_acquire))
     {
-        std::shared_lock lockR(m_mutex);
-        auto iter = m_resolved.find(aTypeName);
-        if (iter != m_resolved.end())
-            return iter->second.get();
+        const auto iter = m_warmedUp.find(aTypeName);
+        if (iter != m_warmedUp.end())
+            return iter->second;
     }
 
-    return CollectRecordInfo(m_rtti->GetClass(aTypeName)).get();
+    std::shared_lock lockR(m_mutex);
+    const auto iter = m_resolved.find(aTypeName);
+    if (iter != m_resolved.end())
+        return iter->second;
+
+    return nullptr;
+}
+
+Core::SharedPtr<Red::TweakDBRecordInfo> Red::TweakDBReflection::FindResolved(Red::CName aTypeName) const
+{
+    if (m_isWarmedUp.load(std::memory_order_acquire))
+    {
+        const auto iter = m_warmedUp.find(aTypeName);
+        if (iter != m_warmedUp.end())
+            return iter->second;
+    }
+
+    const auto iter = m_resolved.find(aTypeName);
+    if (iter != m_resolved.end())
+        return iter->second;
+
+    return nullptr;
+}
+
+size_t Red::TweakDBReflection::WarmUp()
+{
+    if (m_isWarmedUp.load(std::memory_order_acquire))
+        return m_warmedUp.size();
+
+    auto* baseRecordType = m_rtti->GetClass(BaseRecordTypeName);
+
+    Red::DynArray<Red::CClass*> recordTypes;
+    m_rtti->GetClasses(baseRecordType, recordTypes);
+
+    // Types are grouped by depth, so that every parent is resolved before its descendants
+    // and they can reuse its properties instead of collecting them again.
+    Core::Vector<Core::Vector<const Red::CClass*>> levels;
+
+    for (const auto* recordType : recordTypes)
+    {
+        if (!IsRecordType(recordType))
+            continue;
+
+        size_t depth = 0;
+        for (auto* parent = recordType->parent; parent && parent != baseRecordType; parent = parent->parent)
+        {
+            ++depth;
+        }
+
+        if (levels.size() <= depth)
+        {
+            levels.resize(depth + 1);
+        }
+
+        levels[depth].push_back(recordType);
+    }
+
+    for (const auto& level : levels)
+    {
+        Core::ParallelFor(level.size(), [&](size_t aIndex) {
+            GetRecordInfo(level[aIndex]);
+        });
+    }
+
+    {
+        std::unique_lock lockRW(m_mutex);
+
+        m_warmedUp = std::move(m_resolved);
+        m_resolved.clear();
+    }
+
+    m_isWarmedUp.store(true, std::memory_order_release);
+
+    return m_warmedUp.size();
 }
 
 Core::SharedPtr<Red::TweakDBRecordInfo> Red::TweakDBReflection::CollectRecordInfo(
@@ -81,12 +177,17 @@ Core::SharedPtr<Red::TweakDBRecordInfo> Red::TweakDBReflection::CollectRecordInf
     recordInfo->typeHash = GetRecordTypeHash(aType);
     recordInfo->shortName = GetRecordShortName(aType->name);
 
-    const auto parentInfo = CollectRecordInfo(aType->parent, sampleId);
+    auto parentInfo = FindRecordInfo(aType->parent->GetName());
+    if (!parentInfo)
+    {
+        parentInfo = CollectRecordInfo(aType->parent, sampleId);
+    }
+
     if (parentInfo)
     {
         recordInfo->parent = aType->parent;
-        recordInfo->props.insert(parentInfo->props.begin(), parentInfo->props.end());
         recordInfo->extraFlats = parentInfo->extraFlats;
+        InheritProps(*recordInfo, *parentInfo);
     }
 
     const auto baseOffset = aType->parent->size;
@@ -100,6 +201,7 @@ Core::SharedPtr<Red::TweakDBRecordInfo> Red::TweakDBReflection::CollectRecordInf
         auto propInfo = Red::MakeInstance<Red::TweakDBPropertyInfo>();
         propInfo->name = Red::CName(propName.c_str());
         propInfo->dataOffset = baseOffset + (recordInfo->props.size() * DataOffsetSize);
+        propInfo->defaultValue = -1;
 
         // Case: Foreign Key Array => TweakDBID[]
         if (!func->returnType)
@@ -209,54 +311,69 @@ Core::SharedPtr<Red::TweakDBRecordInfo> Red::TweakDBReflection::CollectRecordInf
         recordInfo->props[propInfo->name] = propInfo;
     }
 
+    CompleteRecordInfo(*recordInfo);
+
     {
-        auto extraFlatsIt = s_extraFlats.find(aType->name);
-        if (extraFlatsIt != s_extraFlats.end())
-        {
-            recordInfo->extraFlats = true;
+        std::unique_lock lockRW(m_mutex);
+        m_resolved.insert({ recordInfo->name, recordInfo });
+    }
 
-            for (const auto& extraFlat : extraFlatsIt.value())
-            {
-                auto propInfo = Red::MakeInstance<Red::TweakDBPropertyInfo>();
-                propInfo->name = Red::CName(extraFlat.appendix.c_str() + 1);
-                propInfo->appendix = extraFlat.appendix;
-                propInfo->type = m_rtti->GetType(extraFlat.typeName);
+    return recordInfo;
+}
 
-                if (propInfo->type->GetType() == Red::ERTTIType::Array)
-                {
-                    const auto arrayType = reinterpret_cast<const Red::CRTTIArrayType*>(propInfo->type);
-                    propInfo->elementType = arrayType->innerType;
-                    propInfo->isArray = true;
-                }
+void Red::TweakDBReflection::InheritProps(Red::TweakDBRecordInfo& aRecordInfo,
+                                           const Red::TweakDBRecordInfo& aParentInfo)
+{
+    // Every type gets its own copy of the inherited properties, because the default values differ per type,
+    // which also keeps sibling types resolved in parallel from writing to the same property.
+    for (const auto& [propName, propInfo] : aParentInfo.props)
+    {
+        aRecordInfo.props[propName] = Red::MakeInstance<Red::TweakDBPropertyInfo>(*propInfo);
+    }
+}
 
-                if (!extraFlat.foreignTypeName.IsNone())
-                {
-                    propInfo->foreignType = m_rtti->GetClass(extraFlat.foreignTypeName);
-                    propInfo->isForeignKey = true;
-                }
+void Red::TweakDBReflection::CompleteRecordInfo(Red::TweakDBRecordInfo& aRecordInfo)
+{
+    auto extraFlatsIt = s_extraFlats.find(aRecordInfo.name);
+    if (extraFlatsIt != s_extraFlats.end())
+    {
+        aRecordInfo.extraFlats = true;
 
-                propInfo->dataOffset = 0;
-                propInfo->defaultValue = -1;
+        for (const auto& extraFlat : extraFlatsIt.value())
+        {
+            auto propInfo = Red::MakeInstance<Red::TweakDBPropertyInfo>();
+            propInfo->name = Red::CName(extraFlat.appendix.c_str() + 1);
+            propInfo->appendix = extraFlat.appendix;
+            propInfo->type = m_rtti->GetType(extraFlat.typeName);
 
-                recordInfo->props[propInfo->name] = propInfo;
+            if (propInfo->type->GetType() == Red::ERTTIType::Array)
+            {
+                const auto arrayType = reinterpret_cast<const Red::CRTTIArrayType*>(propInfo->type);
+                propInfo->elementType = arrayType->innerType;
+                propInfo->isArray = true;
             }
-        }
-    }
 
-    for (auto& [_, propInfo] : recordInfo->props)
-    {
-        if (propInfo->dataOffset)
-        {
-            propInfo->defaultValue = ResolveDefaultValue(aType, propInfo->appendix);
+            if (!extraFlat.foreignTypeName.IsNone())
+            {
+                propInfo->foreignType = m_rtti->GetClass(extraFlat.foreignTypeName);
+                propInfo->isForeignKey = true;
+            }
+
+            propInfo->dataOffset = 0;
+            propInfo->defaultValue = -1;
+
+            aRecordInfo.props[propInfo->name] = propInfo;
         }
     }
 
+    // Defaults are resolved per record type, inherited properties don't keep the default of the parent
+    for (auto& [propName, propInfo] : aRecordInfo.props)
     {
-        std::unique_lock lockRW(m_mutex);
-        m_resolved.insert({ recordInfo->name, recordInfo });
-    }
+        if (!propInfo->dataOffset)
+            continue;
 
-    return recordInfo;
+        propInfo->defaultValue = ResolveDefaultValue(aRecordInfo.type, propInfo->appendix);
+    }
 }
 
 Red::TweakDBID Red::TweakDBReflection::GetRecordSampleId(const Red::CClass* aType)
@@ -322,6 +439,254 @@ int32_t Red::TweakDBReflection::ResolveDefaultValue(const Red::CClass* aType, co
     return defaultFlat->ToTDBOffset();
 }
 
+void Red::TweakDBReflection::SetCachePath(std::filesystem::path aPath)
+{
+    m_cachePath = std::move(aPath);
+}
+
+bool Red::TweakDBReflection::LoadCache()
+{
+    if (m_cachePath.empty())
+        return false;
+
+    Core::Vector<uint8_t> buffer;
+    if (!Core::ReadFile(m_cachePath, buffer))
+        return false;
+
+    Core::BinaryReader reader(buffer.data(), buffer.size());
+
+    if (reader.Read<uint32_t>() != CacheMagic || reader.Read<uint32_t>() != CacheVersion
+        || reader.Read<uint64_t>() != GetGameVersion())
+        return false;
+
+    struct CachedRecord
+    {
+        const Red::CClass* type;
+        const Red::CClass* parent;
+        uint32_t typeHash;
+        Core::Vector<Core::SharedPtr<Red::TweakDBPropertyInfo>> props;
+    };
+
+    const auto getType = [&](uint64_t aTypeName) -> const Red::CBaseRTTIType* {
+        return aTypeName ? m_rtti->GetType(Red::CName(aTypeName)) : nullptr;
+    };
+
+    Core::Map<Red::CName, CachedRecord> cachedRecords;
+
+    const auto recordCount = reader.Read<uint32_t>();
+
+    for (uint32_t i = 0; i < recordCount && !reader.IsFailed(); ++i)
+    {
+        CachedRecord cachedRecord{};
+
+        cachedRecord.type = m_rtti->GetClass(Red::CName(reader.Read<uint64_t>()));
+        cachedRecord.parent = m_rtti->GetClass(Red::CName(reader.Read<uint64_t>()));
+        cachedRecord.typeHash = reader.Read<uint32_t>();
+
+        const auto funcCount = reader.Read<uint32_t>();
+
+        // The cache is discarded as a whole if any record type doesn't match the runtime
+        if (!IsRecordType(cachedRecord.type) || cachedRecord.type->parent != cachedRecord.parent
+            || cachedRecord.type->funcs.size != funcCount)
+            return false;
+
+        const auto propCount = reader.Read<uint32_t>();
+
+        for (uint32_t j = 0; j < propCount && !reader.IsFailed(); ++j)
+        {
+            auto propInfo = Red::MakeInstance<Red::TweakDBPropertyInfo>();
+            propInfo->name = Red::CName(reader.Read<uint64_t>());
+            propInfo->appendix = reader.ReadString();
+            propInfo->type = getType(reader.Read<uint64_t>());
+            propInfo->elementType = getType(reader.Read<uint64_t>());
+            propInfo->foreignType = reinterpret_cast<const Red::CClass*>(getType(reader.Read<uint64_t>()));
+            propInfo->isArray = reader.Read<bool>();
+            propInfo->isForeignKey = reader.Read<bool>();
+            propInfo->dataOffset = reader.Read<uint64_t>();
+            propInfo->defaultValue = -1;
+
+            if (!propInfo->type || (propInfo->isArray && !propInfo->elementType)
+                || (propInfo->isForeignKey && !propInfo->foreignType))
+                return false;
+
+            cachedRecord.props.push_back(std::move(propInfo));
+        }
+
+        cachedRecords.insert({cachedRecord.type->name, std::move(cachedRecord)});
+    }
+
+    if (reader.IsFailed() || !reader.IsEnd())
+        return false;
+
+    // Parents are restored first, so that the inherited properties can be copied like in CollectRecordInfo()
+    RecordInfoMap restored;
+
+    std::function<Core::SharedPtr<Red::TweakDBRecordInfo>(Red::CName)> restoreRecord;
+    restoreRecord = [&](Red::CName aTypeName) -> Core::SharedPtr<Red::TweakDBRecordInfo> {
+        if (const auto it = restored.find(aTypeName); it != restored.end())
+            return it->second;
+
+        const auto cachedIt = cachedRecords.find(aTypeName);
+        if (cachedIt == cachedRecords.end())
+            return nullptr;
+
+        const auto& cachedRecord = cachedIt->second;
+
+        auto recordInfo = Red::MakeInstance<Red::TweakDBRecordInfo>();
+        recordInfo->name = aTypeName;
+        recordInfo->type = cachedRecord.type;
+        recordInfo->typeHash = cachedRecord.typeHash;
+        recordInfo->shortName = GetRecordShortName(aTypeName);
+
+        const auto parentInfo = restoreRecord(cachedRecord.parent->name);
+        if (parentInfo)
+        {
+            recordInfo->parent = cachedRecord.parent;
+            recordInfo->extraFlats = parentInfo->extraFlats;
+            InheritProps(*recordInfo, *parentInfo);
+        }
+
+        for (const auto& propInfo : cachedRecord.props)
+        {
+            recordInfo->props[propInfo->name] = propInfo;
+        }
+
+        CompleteRecordInfo(*recordInfo);
+
+        restored.insert({aTypeName, recordInfo});
+
+        return recordInfo;
+    };
+
+    // A record parent must be either cached as well or not a record type
+    for (const auto& [typeName, cachedRecord] : cachedRecords)
+    {
+        if (IsRecordType(cachedRecord.parent) && !cachedRecords.contains(cachedRecord.parent->name))
+            return false;
+    }
+
+    for (const auto& [typeName, cachedRecord] : cachedRecords)
+    {
+        restoreRecord(typeName);
+    }
+
+    {
+        std::unique_lock lockRW(m_mutex);
+
+        for (const auto& [typeName, recordInfo] : restored)
+        {
+            if (!FindResolved(typeName))
+                m_resolved.insert({typeName, recordInfo});
+        }
+
+        m_cachedRecords = m_warmedUp.size() + m_resolved.size();
+    }
+
+    return true;
+}
+
+bool Red::TweakDBReflection::SaveCache()
+{
+    if (m_cachePath.empty())
+        return false;
+
+    Core::BinaryWriter writer;
+
+    {
+        std::unique_lock lockRW(m_mutex);
+
+        const auto recordCount = m_warmedUp.size() + m_resolved.size();
+
+        if (recordCount == m_cachedRecords)
+            return true;
+
+        writer.Write(CacheMagic);
+        writer.Write(CacheVersion);
+        writer.Write(GetGameVersion());
+        writer.Write(static_cast<uint32_t>(recordCount));
+
+        ForEachResolved([&](Red::CName aTypeName, const Core::SharedPtr<Red::TweakDBRecordInfo>& aRecordInfo) {
+            const auto parentInfo = aRecordInfo->parent ? FindResolved(aRecordInfo->parent->name) : nullptr;
+
+            // Only the properties declared by the type itself are stored,
+            // the extra flats are added again from the metadata on load
+            Core::Vector<const Red::TweakDBPropertyInfo*> ownProps;
+
+            for (const auto& [propName, propInfo] : aRecordInfo->props)
+            {
+                if (!propInfo->dataOffset)
+                    continue;
+
+                if (parentInfo && parentInfo->props.contains(propName))
+                    continue;
+
+                ownProps.push_back(propInfo.get());
+            }
+
+            writer.Write(aTypeName.hash);
+            writer.Write(aRecordInfo->type->parent->name.hash);
+            writer.Write(aRecordInfo->typeHash);
+            writer.Write(aRecordInfo->type->funcs.size);
+            writer.Write(static_cast<uint32_t>(ownProps.size()));
+
+            for (const auto* propInfo : ownProps)
+            {
+                writer.Write(propInfo->name.hash);
+                writer.WriteString(propInfo->appendix);
+                writer.Write(GetTypeHash(propInfo->type));
+                writer.Write(GetTypeHash(propInfo->elementType));
+                writer.Write(GetTypeHash(propInfo->foreignType));
+                writer.Write(propInfo->isArray);
+                writer.Write(propInfo->isForeignKey);
+                writer.Write(static_cast<uint64_t>(propInfo->dataOffset));
+            }
+        });
+
+        m_cachedRecords = recordCount;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(m_cachePath.parent_path(), error);
+
+    auto tempPath = m_cachePath;
+    tempPath += L".tmp";
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        file.write(reinterpret_cast<const char*>(writer.GetBuffer().data()),
+                   static_cast<std::streamsize>(writer.GetSize()));
+
+        if (!file)
+            return false;
+    }
+
+    std::filesystem::rename(tempPath, m_cachePath, error);
+
+    return !error;
+}
+
+Core::Vector<int32_t*> Red::TweakDBReflection::GetDefaultValueRefs()
+{
+    Core::Set<int32_t*> refs;
+
+    {
+        std::shared_lock lockR(m_mutex);
+
+        ForEachResolved([&refs](Red::CName, const Core::SharedPtr<Red::TweakDBRecordInfo>& aRecordInfo) {
+            for (const auto& [propName, propInfo] : aRecordInfo->props)
+            {
+                if (propInfo->defaultValue >= 0)
+                    refs.insert(&propInfo->defaultValue);
+            }
+        });
+    }
+
+    return {refs.begin(), refs.end()};
+}
+
 const Red::CBaseRTTIType* Red::TweakDBReflection::GetFlatType(Red::CName aTypeName)
 {
     const Red::CBaseRTTIType* type = m_rtti->GetType(aTypeName);
@@ -644,32 +1009,152 @@ void Red::TweakDBReflection::RegisterExtraFlat(Red::CName aRecordType, const std
 void Red::TweakDBReflection::RegisterDescendants(Red::TweakDBID aParentId,
                                                 const Core::Set<Red::TweakDBID>& aDescendantIds)
 {
-    s_descendantMap[aParentId].insert(aDescendantIds.begin(), aDescendantIds.end());
+    s_pendingLinks.reserve(s_pendingLinks.size() + aDescendantIds.size());
+
+    for (const auto& descendantId : aDescendantIds)
+    {
+        s_pendingLinks.push_back({descendantId, aParentId});
+    }
+}
+
+void Red::TweakDBReflection::RegisterDescendants(Red::TweakDBID aParentId,
+                                                std::span<const Red::TweakDBID> aDescendantIds)
+{
+    s_pendingLinks.reserve(s_pendingLinks.size() + aDescendantIds.size());
 
     for (const auto& descendantId : aDescendantIds)
     {
-        s_parentMap[descendantId] = aParentId;
+        s_pendingLinks.push_back({descendantId, aParentId});
+    }
+}
+
+void Red::TweakDBReflection::BuildInheritanceMap()
+{
+    if (s_pendingLinks.empty())
+        return;
+
+    auto links = std::move(s_pendingLinks);
+    s_pendingLinks = {};
+
+    // Keep the last registered parent of every record, as repeated registrations did before
+    std::ranges::stable_sort(links, {},
+                             [](const Red::TweakDBInheritanceLink& aLink) { return aLink.recordId.value; });
+
+    s_parentIndex.clear();
+    s_parentIndex.reserve(links.size());
+
+    for (const auto& link : links)
+    {
+        if (!s_parentIndex.empty() && s_parentIndex.back().recordId == link.recordId)
+            s_parentIndex.back().parentId = link.parentId;
+        else
+            s_parentIndex.push_back(link);
+    }
+
+    s_parentIndex.shrink_to_fit();
+
+    // The same record may still be listed as a descendant of several parents
+    std::ranges::sort(links, {}, [](const Red::TweakDBInheritanceLink& aLink) {
+        return std::pair(aLink.parentId.value, aLink.recordId.value);
+    });
+
+    s_baseIds.clear();
+    s_descendantOffsets.clear();
+    s_descendantIds.clear();
+    s_descendantIds.reserve(links.size());
+
+    for (size_t i = 0; i < links.size(); ++i)
+    {
+        const auto& link = links[i];
+
+        if (i > 0 && links[i - 1].parentId == link.parentId)
+        {
+            if (links[i - 1].recordId == link.recordId)
+                continue;
+        }
+        else
+        {
+            s_baseIds.push_back(link.parentId);
+            s_descendantOffsets.push_back(static_cast<uint32_t>(s_descendantIds.size()));
+        }
+
+        s_descendantIds.push_back(link.recordId);
     }
+
+    s_descendantOffsets.push_back(static_cast<uint32_t>(s_descendantIds.size()));
+
+    s_baseIds.shrink_to_fit();
+    s_descendantOffsets.shrink_to_fit();
+    s_descendantIds.shrink_to_fit();
+}
+
+void Red::TweakDBReflection::LoadInheritanceMap(std::span<const Red::TweakDBID> aBaseIds,
+                                               std::span<const uint32_t> aOffsets,
+                                               std::span<const Red::TweakDBID> aDescendantIds,
+                                               std::span<const Red::TweakDBInheritanceLink> aParents)
+{
+    s_pendingLinks.clear();
+    s_baseIds.assign(aBaseIds.begin(), aBaseIds.end());
+    s_descendantOffsets.assign(aOffsets.begin(), aOffsets.end());
+    s_descendantIds.assign(aDescendantIds.begin(), aDescendantIds.end());
+    s_parentIndex.assign(aParents.begin(), aParents.end());
+}
+
+Red::TweakDBInheritanceStats Red::TweakDBReflection::GetInheritanceStats()
+{
+    Red::TweakDBInheritanceStats stats{};
+    stats.baseRecords = s_baseIds.size();
+    stats.descendants = s_parentIndex.size();
+    stats.size = s_parentIndex.capacity() * sizeof(Red::TweakDBInheritanceLink)
+                 + s_baseIds.capacity() * sizeof(Red::TweakDBID)
+                 + s_descendantOffsets.capacity() * sizeof(uint32_t)
+                 + s_descendantIds.capacity() * sizeof(Red::TweakDBID);
+
+    return stats;
 }
 
 bool Red::TweakDBReflection::IsOriginalRecord(Red::TweakDBID aRecordId)
 {
-    return s_parentMap.contains(aRecordId);
+    const auto it = std::ranges::lower_bound(s_parentIndex, aRecordId.value, {}, [](const auto& aLink) {
+        return aLink.recordId.value;
+    });
+
+    return it != s_parentIndex.end() && it->recordId == aRecordId;
 }
 
 bool Red::TweakDBReflection::IsOriginalBaseRecord(Red::TweakDBID aParentId)
 {
-    return s_descendantMap.contains(aParentId);
+    const auto it = std::ranges::lower_bound(s_baseIds, aParentId.value, {},
+                                             [](const Red::TweakDBID& aId) { return aId.value; });
+
+    return it != s_baseIds.end() && *it == aParentId;
 }
 
 Red::TweakDBID Red::TweakDBReflection::GetOriginalParent(Red::TweakDBID aRecordId)
 {
-    return s_parentMap[aRecordId];
+    const auto it = std::ranges::lower_bound(s_parentIndex, aRecordId.value, {}, [](const auto& aLink) {
+        return aLink.recordId.value;
+    });
+
+    if (it == s_parentIndex.end() || it->recordId != aRecordId)
+        return {};
+
+    return it->parentId;
 }
 
-const Core::Set<Red::TweakDBID>& Red::TweakDBReflection::GetOriginalDescendants(Red::TweakDBID aSourceId)
+std::span<const Red::TweakDBID> Red::TweakDBReflection::GetOriginalDescendants(Red::TweakDBID aSourceId)
 {
-    return s_descendantMap[aSourceId];
+    const auto it = std::ranges::lower_bound(s_baseIds, aSourceId.value, {},
+                                             [](const Red::TweakDBID& aId) { return aId.value; });
+
+    if (it == s_baseIds.end() || *it != aSourceId)
+        return {};
+
+    const auto index = static_cast<size_t>(it - s_baseIds.begin());
+    const auto begin = s_descendantOffsets[index];
+    const auto end = s_descendantOffsets[index + 1];
+
+    return {s_descendantIds.data() + begin, end - begin};
 }
 
 std::string Red::TweakDBReflection::ToString(Red::TweakDBID aID)
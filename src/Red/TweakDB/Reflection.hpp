@@ -67,6 +67,19 @@ struct TweakDBRecordInfo
     }
 };
 
+struct TweakDBInheritanceLink
+{
+    Red::TweakDBID recordId;
+    Red::TweakDBID parentId;
+};
+
+struct TweakDBInheritanceStats
+{
+    size_t baseRecords;
+    size_t descendants;
+    size_t size; // Memory used by the sorted arrays
+};
+
 class TweakDBReflection
 {
 public:
@@ -76,6 +89,10 @@ public:
     const Red::TweakDBRecordInfo* GetRecordInfo(Red::CName aTypeName);
     const Red::TweakDBRecordInfo* GetRecordInfo(const Red::CClass* aType);
 
+    // Resolves all record types in parallel and publishes them as an immutable table,
+    // so that the following lookups of these types don't need locking.
+    size_t WarmUp();
+
     const Red::CBaseRTTIType* GetFlatType(Red::CName aTypeName);
     const Red::CClass* GetRecordType(Red::CName aTypeName);
     const Red::CClass* GetRecordType(const char* aTypeName);
@@ -125,11 +142,31 @@ public:
     bool IsOriginalRecord(Red::TweakDBID aRecordId);
     bool IsOriginalBaseRecord(Red::TweakDBID aParentId);
     Red::TweakDBID GetOriginalParent(Red::TweakDBID aRecordId);
-    const Core::Set<Red::TweakDBID>& GetOriginalDescendants(Red::TweakDBID aSourceId);
+    std::span<const Red::TweakDBID> GetOriginalDescendants(Red::TweakDBID aSourceId);
 
     void RegisterExtraFlat(Red::CName aRecordType, const std::string& aPropName, Red::CName aPropType,
                            Red::CName aForeignType);
     void RegisterDescendants(Red::TweakDBID aParentId, const Core::Set<Red::TweakDBID>& aDescendantIds);
+    void RegisterDescendants(Red::TweakDBID aParentId, std::span<const Red::TweakDBID> aDescendantIds);
+
+    // The registered descendants are only visible after the inheritance map is built.
+    // The map is then stored in sorted flat arrays and doesn't change anymore.
+    void BuildInheritanceMap();
+
+    // Takes the arrays of an already built map as is, replacing the current map.
+    void LoadInheritanceMap(std::span<const Red::TweakDBID> aBaseIds, std::span<const uint32_t> aOffsets,
+                            std::span<const Red::TweakDBID> aDescendantIds,
+                            std::span<const Red::TweakDBInheritanceLink> aParents);
+    Red::TweakDBInheritanceStats GetInheritanceStats();
+
+    // The resolved record types are cached between launches of the same game version.
+    // Only the default values are resolved again, since they depend on the live flat buffer.
+    void SetCachePath(std::filesystem::path aPath);
+    bool LoadCache();
+    bool SaveCache();
+
+    // Offsets of the resolved default values, which must follow the values when the buffer is compacted.
+    Core::Vector<int32_t*> GetDefaultValueRefs();
 
     std::string ToString(Red::TweakDBID aID);
 
@@ -143,24 +180,57 @@ private:
         std::string appendix;
     };
 
-    using ParentMap = Core::Map<Red::TweakDBID, Red::TweakDBID>;
-    using DescendantMap = Core::Map<Red::TweakDBID, Core::Set<Red::TweakDBID>>;
+    // Compressed sparse row layout: the descendants of s_baseIds[i] are stored
+    // in s_descendantIds at the range [s_descendantOffsets[i], s_descendantOffsets[i + 1]).
+    using InheritanceKeys = Core::Vector<Red::TweakDBID>;
+    using InheritanceOffsets = Core::Vector<uint32_t>;
+    using ParentIndex = Core::Vector<Red::TweakDBInheritanceLink>;
     using ExtraFlatMap = Core::Map<Red::CName, Core::Vector<ExtraFlat>>;
     using RecordInfoMap = Core::Map<Red::CName, Core::SharedPtr<Red::TweakDBRecordInfo>>;
 
     Core::SharedPtr<Red::TweakDBRecordInfo> CollectRecordInfo(const Red::CClass* aType, Red::TweakDBID aSampleId = {});
+    void InheritProps(Red::TweakDBRecordInfo& aRecordInfo, const Red::TweakDBRecordInfo& aParentInfo);
+    void CompleteRecordInfo(Red::TweakDBRecordInfo& aRecordInfo);
+    Core::SharedPtr<Red::TweakDBRecordInfo> FindRecordInfo(Red::CName aTypeName);
+
+    // Must be called with m_mutex held.
+    Core::SharedPtr<Red::TweakDBRecordInfo> FindResolved(Red::CName aTypeName) const;
+
+    // Must be called with m_mutex held.
+    template<typename Callback>
+    void ForEachResolved(Callback&& aCallback) const
+    {
+        if (m_isWarmedUp.load(std::memory_order_acquire))
+        {
+            for (const auto& [typeName, recordInfo] : m_warmedUp)
+                aCallback(typeName, recordInfo);
+        }
+
+        for (const auto& [typeName, recordInfo] : m_resolved)
+            aCallback(typeName, recordInfo);
+    }
     Red::TweakDBID GetRecordSampleId(const Red::CClass* aType);
     uint32_t GetRecordTypeHash(const Red::CClass* aType);
     std::string ResolvePropertyName(Red::TweakDBID aSampleId, Red::CName aGetterName);
     int32_t ResolveDefaultValue(const Red::CClass* aType, const std::string& aPropName);
 
+    static constexpr uint32_t CacheMagic = 0x52445854; // TXDR
+    static constexpr uint32_t CacheVersion = 1;
+
     Red::TweakDB* m_tweakDb;
     Red::CRTTISystem* m_rtti;
     RecordInfoMap m_resolved;
+    RecordInfoMap m_warmedUp;
+    std::atomic<bool> m_isWarmedUp;
     std::shared_mutex m_mutex;
-
-    inline static ParentMap s_parentMap;
-    inline static DescendantMap s_descendantMap;
+    std::filesystem::path m_cachePath;
+    size_t m_cachedRecords;
+
+    inline static ParentIndex s_pendingLinks;
+    inline static ParentIndex s_parentIndex;
+    inline static InheritanceKeys s_baseIds;
+    inline static InheritanceOffsets s_descendantOffsets;
+    inline static InheritanceKeys s_descendantIds;
     inline static ExtraFlatMap s_extraFlats;
 };
 }
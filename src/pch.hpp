@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <concepts>
 #include <cstdint>
 #include <filesystem>
@@ -12,8 +13,10 @@
 #include <ranges>
 #include <set>
 #include <source_location>
+#include <span>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -39,6 +42,7 @@
 #include <semver.hpp>
 #include <tao/pegtl.hpp>
 #include <yaml-cpp/yaml.h>
+#include <yaml-cpp/eventhandler.h>
 
 #include "Core/Raw.hpp"
 #include "Core/Stl.hpp"
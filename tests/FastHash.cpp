@@ -0,0 +1,129 @@
+// Known-answer test for Core::FastHash64.
+// The same file is built with and without AVX2, both builds must produce the exact same hashes.
+
+#include "Core/Hashing/FastHash.hpp"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+struct KnownAnswer
+{
+    size_t size;
+    uint64_t seed;
+    uint64_t hash;
+};
+
+// Covers the short paths, the 16 and 48 byte loops, the stripe threshold and partial stripes
+constexpr KnownAnswer KnownAnswers[] = {
+    {0, 0x0ull, 0x0409638EE2BDE459ull},
+    {0, 0x5BD1E995ull, 0xADA3FF0BF5FA608Dull},
+    {1, 0x0ull, 0x1066361B49E64E2Dull},
+    {1, 0x5BD1E995ull, 0xCBDB321DB669F376ull},
+    {3, 0x0ull, 0xBA2DFE9FF3C1DA4Eull},
+    {3, 0x5BD1E995ull, 0x1801818BAB0EC490ull},
+    {4, 0x0ull, 0xC07E7A5706E1ABD0ull},
+    {4, 0x5BD1E995ull, 0x0CEF62757FAB26FDull},
+    {7, 0x0ull, 0x54B09081B33B08ADull},
+    {7, 0x5BD1E995ull, 0x11D7ADD080B762D6ull},
+    {8, 0x0ull, 0xB528210708F73F35ull},
+    {8, 0x5BD1E995ull, 0x9D825EAFD36A6568ull},
+    {15, 0x0ull, 0x62ACCBF420C0D460ull},
+    {15, 0x5BD1E995ull, 0x603D15D38AE1105Bull},
+    {16, 0x0ull, 0xB9DB3612D250B7B0ull},
+    {16, 0x5BD1E995ull, 0x107A51A068FFCC5Bull},
+    {17, 0x0ull, 0x6F6EBB36F62C7291ull},
+    {17, 0x5BD1E995ull, 0xD052EDCF5CCE5B88ull},
+    {32, 0x0ull, 0x670926E8BE9DC3D0ull},
+    {32, 0x5BD1E995ull, 0xADF5D1D79F49450Dull},
+    {48, 0x0ull, 0xA7205E20E9A020BAull},
+    {48, 0x5BD1E995ull, 0xB158401487E79E26ull},
+    {49, 0x0ull, 0xA95D6B90143C7897ull},
+    {49, 0x5BD1E995ull, 0x3D16C579100B0DF1ull},
+    {96, 0x0ull, 0xA850269C41808B99ull},
+    {96, 0x5BD1E995ull, 0xE4C63D38F000DA45ull},
+    {97, 0x0ull, 0xE7BF8FD6B6B5697Eull},
+    {97, 0x5BD1E995ull, 0x6658BB559490F8D9ull},
+    {255, 0x0ull, 0xC982205309181D04ull},
+    {255, 0x5BD1E995ull, 0xA4B59997DB8E08A1ull},
+    {256, 0x0ull, 0xFB20CDEEFA60A46Aull},
+    {256, 0x5BD1E995ull, 0xC8BA54970D6F977Aull},
+    {257, 0x0ull, 0xB2740CDA5786B422ull},
+    {257, 0x5BD1E995ull, 0xEEFF0A26626B4527ull},
+    {319, 0x0ull, 0xB35AC83BE589E414ull},
+    {319, 0x5BD1E995ull, 0xDF33736C01F4CAD8ull},
+    {320, 0x0ull, 0xE96303339A7CC0DBull},
+    {320, 0x5BD1E995ull, 0xCD6FC19A93E8577Eull},
+    {321, 0x0ull, 0xB2253241D53F0C26ull},
+    {321, 0x5BD1E995ull, 0x0E6502CCA34BB3B3ull},
+    {1024, 0x0ull, 0xFBC4197063F9CC53ull},
+    {1024, 0x5BD1E995ull, 0x0949633AB97F6CBDull},
+    {2048, 0x0ull, 0xCE5CC0BC0278B196ull},
+    {2048, 0x5BD1E995ull, 0xB61EABA77FF2076Dull},
+};
+
+// Hash of the hashes of every input size up to MaxDigestSize
+constexpr size_t MaxDigestSize = 2048;
+constexpr uint64_t KnownDigest = 0x6C36FE0C0FF6B84Aull;
+
+std::vector<uint8_t> MakeInput(size_t aSize)
+{
+    std::vector<uint8_t> data(aSize);
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    for (auto& byte : data)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        byte = static_cast<uint8_t>(state >> 56);
+    }
+
+    return data;
+}
+}
+
+int main()
+{
+#ifdef __AVX2__
+    std::printf("FastHash64 known-answer test (AVX2)\n");
+#else
+    std::printf("FastHash64 known-answer test (SSE2)\n");
+#endif
+
+    const auto input = MakeInput(MaxDigestSize);
+    auto failures = 0;
+
+    for (const auto& answer : KnownAnswers)
+    {
+        const auto hash = Core::FastHash64(input.data(), answer.size, answer.seed);
+
+        if (hash != answer.hash)
+        {
+            std::printf("  size %zu, seed %llx: expected %016llx, got %016llx\n", answer.size,
+                        static_cast<unsigned long long>(answer.seed), static_cast<unsigned long long>(answer.hash),
+                        static_cast<unsigned long long>(hash));
+            ++failures;
+        }
+    }
+
+    std::vector<uint64_t> hashes;
+    hashes.reserve(MaxDigestSize + 1);
+
+    for (size_t size = 0; size <= MaxDigestSize; ++size)
+    {
+        hashes.push_back(Core::FastHash64(input.data(), size, size));
+    }
+
+    const auto digest = Core::FastHash64(hashes.data(), hashes.size() * sizeof(uint64_t));
+
+    if (digest != KnownDigest)
+    {
+        std::printf("  digest of sizes 0..%zu: expected %016llx, got %016llx\n", MaxDigestSize,
+                    static_cast<unsigned long long>(KnownDigest), static_cast<unsigned long long>(digest));
+        ++failures;
+    }
+
+    std::printf(failures ? "FAILED\n" : "OK\n");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,179 @@
+// Stress test for Red::TweakDBFlatPool.
+// Many threads allocate the same values at once, every value must end up with exactly one offset,
+// the same for every thread, as TweakDBBuffer::AllocateValue relies on it.
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Red/TweakDB/FlatPool.hpp"
+
+namespace
+{
+constexpr size_t ThreadCount = 8;
+constexpr size_t ValueCount = 16384; // a power of two, so every thread visits all values
+constexpr size_t Rounds = 4;
+
+// Stands in for the flat buffer, an offset is the index of the stored value
+class Buffer
+{
+public:
+    explicit Buffer(size_t aCapacity)
+        : m_values(aCapacity)
+        , m_size(1) // offset 0 is never handed out, same as in the flat buffer
+    {
+    }
+
+    int32_t Append(uint64_t aValue)
+    {
+        const auto offset = m_size.fetch_add(1);
+        m_values[offset].store(aValue, std::memory_order_relaxed);
+        return static_cast<int32_t>(offset);
+    }
+
+    [[nodiscard]] uint64_t Get(int32_t aOffset) const
+    {
+        return m_values[aOffset].load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] size_t GetSize() const
+    {
+        return m_size - 1;
+    }
+
+private:
+    std::vector<std::atomic<uint64_t>> m_values;
+    std::atomic<size_t> m_size;
+};
+
+// Spreads the values over all shards, every 16th value collides with the previous one
+uint64_t GetHash(uint64_t aValue)
+{
+    const auto key = (aValue % 16 == 15) ? aValue - 1 : aValue;
+    return key * 0x9E3779B97F4A7C15ull;
+}
+
+bool IsColliding(uint64_t aValue)
+{
+    return aValue % 16 == 15;
+}
+
+// Same sequence as TweakDBBuffer::AllocateValue: lock-free lookup first, then find or create
+int32_t Allocate(Red::TweakDBFlatPool& aPool, Buffer& aBuffer, uint64_t aValue)
+{
+    const auto hash = GetHash(aValue);
+    const auto isSame = [&](int32_t aOffset) { return aBuffer.Get(aOffset) == aValue; };
+
+    const auto offset = aPool.Find(hash, isSame);
+    if (offset != Red::TweakDBFlatPool::InvalidOffset)
+        return offset;
+
+    return aPool.FindOrCreate(hash, isSame, [&]() { return aBuffer.Append(aValue); });
+}
+}
+
+int main()
+{
+    auto failures = 0;
+
+    for (size_t round = 0; round < Rounds; ++round)
+    {
+        Red::TweakDBFlatPool pool;
+        Buffer buffer(ThreadCount * ValueCount + 1);
+
+        std::vector<std::vector<int32_t>> offsets(ThreadCount, std::vector<int32_t>(ValueCount));
+        std::vector<std::thread> threads;
+        std::atomic<size_t> ready = 0;
+
+        for (size_t thread = 0; thread < ThreadCount; ++thread)
+        {
+            threads.emplace_back([&, thread]() {
+                ++ready;
+                while (ready < ThreadCount)
+                {
+                    std::this_thread::yield();
+                }
+
+                // Every thread walks the values in a different order to mix the contention,
+                // the step is odd, so the walk is a permutation
+                for (size_t i = 0; i < ValueCount; ++i)
+                {
+                    const auto value = (i * (thread * 2 + 1) + thread * 7919) % ValueCount;
+                    offsets[thread][value] = Allocate(pool, buffer, value);
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        size_t pooledCount = 0;
+
+        for (uint64_t value = 0; value < ValueCount; ++value)
+        {
+            for (size_t thread = 0; thread < ThreadCount; ++thread)
+            {
+                const auto offset = offsets[thread][value];
+
+                if (offset <= 0 || buffer.Get(offset) != value)
+                {
+                    std::printf("  value %llu got a wrong offset %d\n", static_cast<unsigned long long>(value), offset);
+                    ++failures;
+                }
+            }
+
+            const auto pooledOffset = pool.Find(GetHash(value), [&](int32_t aOffset) {
+                return buffer.Get(aOffset) == value;
+            });
+
+            // Of two values with the same hash only the first one created is pooled,
+            // the other one is created by every thread that asks for it
+            if (pooledOffset == Red::TweakDBFlatPool::InvalidOffset)
+            {
+                if (!IsColliding(value) && !IsColliding(value + 1))
+                {
+                    std::printf("  value %llu isn't pooled\n", static_cast<unsigned long long>(value));
+                    ++failures;
+                }
+                continue;
+            }
+
+            ++pooledCount;
+
+            for (size_t thread = 0; thread < ThreadCount; ++thread)
+            {
+                if (offsets[thread][value] != pooledOffset)
+                {
+                    std::printf("  value %llu got offsets %d and %d\n", static_cast<unsigned long long>(value),
+                                pooledOffset, offsets[thread][value]);
+                    ++failures;
+                }
+            }
+        }
+
+        const auto expectedSize = ValueCount - ValueCount / 16;
+
+        if (pooledCount != expectedSize || pool.GetSize() != expectedSize)
+        {
+            std::printf("  pool has %zu values (%zu found), expected %zu\n", pool.GetSize(), pooledCount,
+                        expectedSize);
+            ++failures;
+        }
+
+        const auto maxBufferSize = expectedSize + (ValueCount - expectedSize) * ThreadCount;
+
+        if (buffer.GetSize() > maxBufferSize)
+        {
+            std::printf("  buffer has %zu values, expected at most %zu\n", buffer.GetSize(), maxBufferSize);
+            ++failures;
+        }
+    }
+
+    std::printf(failures ? "FAILED\n" : "OK\n");
+
+    return failures ? 1 : 0;
+}
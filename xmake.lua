@@ -49,6 +49,47 @@ target("TweakXL")
     set_configvar("AUTHOR", "psiberx")
     set_configvar("NAME", "TweakXL")
 
+-- Standalone tests and benchmarks that don't depend on the game,
+-- built with "xmake build -g tests" or "xmake build -g benchmarks" and started with "xmake run <target>"
+
+target("FastHashTest")
+    set_default(false)
+    set_kind("binary")
+    set_group("tests")
+    add_files("tests/FastHash.cpp")
+    add_includedirs("lib/")
+
+target("FastHashTest.AVX2")
+    set_default(false)
+    set_kind("binary")
+    set_group("tests")
+    add_files("tests/FastHash.cpp")
+    add_includedirs("lib/")
+    add_vectorexts("avx2")
+
+target("FlatPoolTest")
+    set_default(false)
+    set_kind("binary")
+    set_group("tests")
+    add_files("tests/FlatPool.cpp")
+    add_includedirs("src/", "lib/")
+    add_packages("hopscotch-map", "tiltedcore")
+
+target("HashingBenchmark")
+    set_default(false)
+    set_kind("binary")
+    set_group("benchmarks")
+    add_files("benchmarks/Hashing.cpp")
+    add_includedirs("lib/")
+
+target("LookupBenchmark")
+    set_default(false)
+    set_kind("binary")
+    set_group("benchmarks")
+    add_files("benchmarks/Lookup.cpp")
+    add_includedirs("src/", "lib/")
+    add_packages("hopscotch-map", "tiltedcore")
+
 target("RED4ext.SDK")
     set_default(false)
     set_kind("static")